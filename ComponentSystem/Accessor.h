@@ -1,6 +1,7 @@
 #ifndef	ACCESSOR_H
 #define ACCESSOR_H
 
+#include <concepts>
 #include <unordered_map>
 #include <string>
 #include <memory>
@@ -9,6 +10,8 @@
 #include "Core.h"
 
 #include "Pool.h"
+#include "CommandBuffer.h"
+#include "CommandRecorder.h"
 
 namespace CECS
 {
@@ -47,21 +50,49 @@ namespace CECS
 			return instance().m_pool->createEntity();
 		}
 
+		template<typename... Args>
+		static EntityRange spawn(size_t count, const Args&... components)
+		{
+			return instance().m_pool->spawn<Args...>(count, components...);
+		}
+
+		template<typename... Args, typename Generator>
+			requires std::invocable<Generator&, EntityID, Args&...>
+		static EntityRange spawn(size_t count, Generator&& generator)
+		{
+			return instance().m_pool->spawn<Args...>(count, generator);
+		}
+
+		static bool isAlive(EntityID id)
+		{
+			return instance().m_pool->isAlive(id);
+		}
+
 		static void destroyEntity(EntityID id)
 		{
 			instance().m_pool->destroyEntity(id);
 		}
 
+		static void destroyEntities(const std::vector<EntityID>& ids)
+		{
+			instance().m_pool->destroyEntities(ids);
+		}
+
+		static void destroyEntities(ObserverPtr<Query> query)
+		{
+			instance().m_pool->destroyEntities(query);
+		}
+
 		template <typename T>
 		static void addComponent(EntityID id, const T& component)
 		{
-			addComponent<T>(id, T{component}, typeid(T).name());
+			instance().m_pool->addComponent<T>(id, T{ component });
 		}
 
 		template <typename T>
 		static void addComponent(EntityID id, T&& component)
 		{
-			addComponent<T>(id, std::move(component), typeid(T).name());
+			instance().m_pool->addComponent<T>(id, std::move(component));
 		}
 
 		template <typename T>
@@ -76,10 +107,22 @@ namespace CECS
 			instance().m_pool->addComponent<T>(id, std::move(component), typeName);
 		}
 
+		template <typename T>
+		static void addComponent(ObserverPtr<Query> query, const T& component)
+		{
+			instance().m_pool->addComponent<T>(query, component);
+		}
+
 		template<typename T>
 		static void removeComponent(EntityID id)
 		{
-			removeComponent(id, typeid(T).name());
+			instance().m_pool->removeComponent<T>(id);
+		}
+
+		template<typename T>
+		static void removeComponent(ObserverPtr<Query> query)
+		{
+			instance().m_pool->removeComponent<T>(query);
 		}
 
 		static void removeComponent(EntityID id, const TypeName& name)
@@ -90,7 +133,7 @@ namespace CECS
 		template<typename T>
 		static T& getComponent(EntityID id)
 		{
-			return getComponent<T>(id, typeid(T).name());
+			return instance().m_pool->getComponent<T>(id);
 		}
 
 		template<typename T>
@@ -99,16 +142,22 @@ namespace CECS
 			return instance().m_pool->getComponent<T>(id, name);
 		}
 
+		template<typename T>
+		static T readComponent(EntityID id)
+		{
+			return instance().m_pool->readComponent<T>(id);
+		}
+
 		template <typename T>
 		static void setComponent(EntityID id, const T& component)
 		{
-			setComponent<T>(id, T{ component }, typeid(T).name());
+			instance().m_pool->setComponent<T>(id, T{ component });
 		}
 
 		template <typename T>
 		static void setComponent(EntityID id, T&& component)
 		{
-			setComponent<T>(id, std::move(component), typeid(T).name());
+			instance().m_pool->setComponent<T>(id, std::move(component));
 		}
 
 		template <typename T>
@@ -126,9 +175,8 @@ namespace CECS
 		template<typename... Args>
 		static void addComponents(EntityID id, Args&&... components)
 		{
-			std::vector<TypeName> typeNames;
-			(typeNames.push_back(typeid(Args).name()), ...);
-			instance().m_pool->addComponents<Args...>(id, std::move(components)..., typeNames);
+			Pool& pool{ *instance().m_pool };
+			pool.addComponents<Args...>(id, std::move(components)..., pool.registerComponents<Args...>());
 		}
 
 		template<typename... Args>
@@ -144,10 +192,15 @@ namespace CECS
 			return out;
 		}
 
+		static EntityRange instantiate(EntityID prefab, size_t count)
+		{
+			return instance().m_pool->instantiate(prefab, count);
+		}
+
 		template<typename T>
 		static bool hasComponent(EntityID id)
 		{
-			return hasComponent(id, typeid(T).name());
+			return instance().m_pool->hasComponent<T>(id);
 		}
 
 		static bool hasComponent(EntityID id, const TypeName& name)
@@ -158,9 +211,7 @@ namespace CECS
 		template<typename... Args>
 		static Signature createSignature()
 		{
-			std::vector<TypeName> typeNames;
-			(typeNames.push_back(typeid(Args).name()), ...);
-			createSignature<Args...>(typeNames);
+			return instance().m_pool->createSignature<Args...>();
 		}
 
 		template<typename... Args>
@@ -171,6 +222,7 @@ namespace CECS
 
 		static Signature createSignature(const std::vector<TypeName>& typeNames)
 		{
+			Pool::StructureLock lock{ *instance().m_pool, false };
 			Signature out;
 			ComponentRegister& components{ getComponentRegister() };
 			for (const TypeName& name: typeNames)
@@ -180,6 +232,33 @@ namespace CECS
 			return out;
 		}
 
+		template<typename... Args>
+		static ObserverPtr<Query> createQuery()
+		{
+			return instance().m_pool->createQuery<Args...>();
+		}
+
+		template<typename... Args>
+		static ObserverPtr<Query> createQuery(const Signature& excluded)
+		{
+			return instance().m_pool->createQuery<Args...>(excluded);
+		}
+
+		static void destroyQuery(ObserverPtr<Query> query)
+		{
+			instance().m_pool->destroyQuery(query);
+		}
+
+		static void playback(CommandBuffer& buffer)
+		{
+			buffer.playback(*instance().m_pool);
+		}
+
+		static void playback(CommandRecorder& recorder)
+		{
+			recorder.playback(*instance().m_pool);
+		}
+
 		static ObserverPtr<Pool> getPool()
 		{
 			return instance().m_pool;
@@ -187,12 +266,12 @@ namespace CECS
 
 		static ClusterID getClusterID(EntityID id)
 		{
-			return instance().m_pool->m_entites.getClusterID(id);
+			return instance().m_pool->getCluster(id).getID();
 		}
 
 		static const Signature& getSignature(EntityID id)
 		{
-			return instance().m_pool->m_entites.getSignature(id);
+			return instance().m_pool->getCluster(id).getSignature();
 		}
 
 		static void carryEntity(EntityID id, ClusterID newCluster)
@@ -10,6 +10,16 @@
 
 namespace CECS
 {
+    constexpr uint64_t mixBits(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccd;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53;
+        value ^= value >> 33;
+        return value;
+    }
+
     template<typename T>
     struct Hash
     {
@@ -53,21 +63,22 @@ namespace CECS
     template<>
     struct Hash<std::string>
     {
-        constexpr uint32_t operator()(const std::string& s) const
+        constexpr size_t operator()(const std::string& s) const
         {
             return operator()(s.c_str());
         }
 
-        constexpr uint32_t operator()(const char* s) const
+        constexpr size_t operator()(const char* s) const
         {
-            uint32_t hash{};
+            uint64_t hash{ 0xcbf29ce484222325 };
 
-            for (uint32_t index{}; s[index]; ++index)
+            for (size_t index{}; s[index]; ++index)
             {
-                hash += (index + 1) * s[index];
+                hash ^= static_cast<unsigned char>(s[index]);
+                hash *= 0x100000001b3;
             }
 
-            return hash;
+            return static_cast<size_t>(hash);
         }
     };
 
@@ -76,12 +87,12 @@ namespace CECS
     {
         size_t operator()(const Signature& signature) const
         {
-            size_t out{};
-            for (const auto& pair : signature.getBitsets())
+            uint64_t out{ 0x9e3779b97f4a7c15 };
+            for (Signature::Word word : signature.getWords())
             {
-                out += (pair.first + 1) * pair.second.to_ullong();
+                out = mixBits(out ^ word);
             }
-            return out;
+            return static_cast<size_t>(out);
         }
     };
 }
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../CECS.h"
+
+using namespace CECS;
+
+struct Position
+{
+	float x, y, z;
+};
+
+struct Velocity
+{
+	float x, y, z;
+};
+
+struct Frozen
+{
+	int value;
+};
+
+struct Visible
+{
+	int value;
+};
+
+template<typename Function>
+double measure(Function&& function)
+{
+	double best{ 1e9 };
+	for (int repeat{}; repeat < 8; ++repeat)
+	{
+		auto start{ std::chrono::steady_clock::now() };
+		function();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	size_t entities{ argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000 };
+
+	for (size_t index{}; index < entities; ++index)
+	{
+		EntityID id{ Accessor::createEntity() };
+		Accessor::addComponents(id, Position{ 1, 2, 3 }, Velocity{ 1, 1, 1 });
+		if (index % 4 == 1 || index % 4 == 3)
+		{
+			Accessor::addComponent(id, Frozen{ 0 });
+		}
+		if (index % 4 >= 2)
+		{
+			Accessor::addComponent(id, Visible{ 0 });
+		}
+	}
+
+	size_t visited{};
+	double iterate{ measure([&]()
+		{
+			visited = 0;
+			for (auto [id, position, velocity] : PoolView<Position, Velocity>{})
+			{
+				position.x += velocity.x;
+				position.y += velocity.y;
+				position.z += velocity.z;
+				++visited;
+			}
+		}) };
+
+	std::printf("entities %zu, clusters 4, visited %zu\n", entities, visited);
+	std::printf("PoolView<Position, Velocity> iteration, %.2f ms, %.2f ns per entity\n", iterate, iterate * 1e6 / static_cast<double>(entities));
+}
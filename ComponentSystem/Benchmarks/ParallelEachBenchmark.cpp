@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../CECS.h"
+
+using namespace CECS;
+
+struct Position
+{
+	float x, y, z;
+};
+
+struct Velocity
+{
+	float x, y, z;
+};
+
+template<typename Function>
+double measure(Function&& function)
+{
+	double best{ 1e9 };
+	for (int repeat{}; repeat < 5; ++repeat)
+	{
+		auto start{ std::chrono::steady_clock::now() };
+		function();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	size_t entities{ argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000 };
+	size_t hardware{ std::max<size_t>(std::thread::hardware_concurrency(), 1) };
+
+	Accessor::spawn<Position, Velocity>(entities, Position{ 1, 2, 3 }, Velocity{ 1, 1, 1 });
+
+	auto heavy{ [](EntityID, Position& position, Velocity& velocity)
+		{
+			for (int step{}; step < 8; ++step)
+			{
+				position.x = std::sqrt(position.x * position.x + velocity.x);
+				position.y += std::sin(position.x) * velocity.y;
+			}
+			position.z += velocity.z;
+		} };
+	auto light{ [](EntityID, Position& position, Velocity& velocity)
+		{
+			position.x += velocity.x;
+			position.y += velocity.y;
+			position.z += velocity.z;
+		} };
+
+	auto sequential{ [](auto& function)
+		{
+			PoolView<Position, Velocity>{}.eachChunk([&function](const EntityID* ids, Position* positions, Velocity* velocities, size_t size)
+				{
+					for (size_t index{}; index < size; ++index)
+					{
+						function(ids[index], positions[index], velocities[index]);
+					}
+				});
+		} };
+
+	double sequentialHeavy{ measure([&]() { sequential(heavy); }) };
+	double sequentialLight{ measure([&]() { sequential(light); }) };
+	std::printf("entities %zu, hardware threads %zu\n", entities, hardware);
+	std::printf("threads, heavy ms, heavy speedup, light ms, light speedup\n");
+	std::printf("sequential, %.2f, 1.00, %.2f, 1.00\n", sequentialHeavy, sequentialLight);
+
+	std::vector<size_t> counts;
+	for (size_t threads{ 1 }; threads < hardware; threads *= 2)
+	{
+		counts.push_back(threads);
+	}
+	counts.push_back(hardware);
+
+	for (size_t threads : counts)
+	{
+		JobSystem jobs{ threads };
+		PoolView<Position, Velocity> view;
+		double parallelHeavy{ measure([&]() { view.parallelEach(heavy, jobs); }) };
+		double parallelLight{ measure([&]() { view.parallelEach(light, jobs); }) };
+		std::printf("%zu, %.2f, %.2f, %.2f, %.2f\n", threads,
+			parallelHeavy, sequentialHeavy / parallelHeavy, parallelLight, sequentialLight / parallelLight);
+	}
+}
\ No newline at end of file
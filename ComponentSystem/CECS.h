@@ -12,20 +12,189 @@
 #include <tuple>
 #include <unordered_map>
 #include <set>
+#include <bit>
+#include <utility>
+#include <new>
+#include <limits>
+#include <cstring>
+#include <atomic>
+#include <array>
+#include <stdexcept>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <shared_mutex>
+#include <cassert>
+#include <optional>
+#include <exception>
+
+#if defined(CECS_HUGE_PAGES) && defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 namespace CECS
 {
-	using EntityID = uint32_t;
+	using EntityID = uint64_t;
+	using Generation = uint32_t;
 	using ComponentID = uint32_t;
+	using TypeID = uint32_t;
 	using ClusterID = uint16_t;
+	using ArchetypeID = uint32_t;
 	using Index = uint32_t;
 	using TypeName = std::string;
 
 	inline constexpr EntityID nullent{ 0 };
 	inline constexpr ClusterID nullcluster{ 0 };
+	inline constexpr ArchetypeID nullarchetype{ std::numeric_limits<ArchetypeID>::max() };
+	inline constexpr ComponentID nullcomponent{ std::numeric_limits<ComponentID>::max() };
+	inline constexpr Index nullcolumn{ std::numeric_limits<Index>::max() };
+
+	inline constexpr size_t GENERATION_SHIFT{ 32 };
+	inline constexpr Generation GENERATION_MASK{ std::numeric_limits<Generation>::max() >> 1 };
 
 	inline constexpr size_t BITSET_SIZE{ 64 };
 
+#ifdef CECS_MAX_COMPONENTS
+	inline constexpr size_t MAX_COMPONENTS{ CECS_MAX_COMPONENTS };
+#else
+	inline constexpr size_t MAX_COMPONENTS{ 256 };
+#endif
+
+
+	class TypeIndex
+	{
+	public:
+		template<typename T>
+		static TypeID get()
+		{
+			return id<std::remove_cvref_t<T>>();
+		}
+
+	private:
+		template<typename T>
+		static TypeID id()
+		{
+			static const TypeID out{ next() };
+			return out;
+		}
+
+		static TypeID next()
+		{
+			static std::atomic<TypeID> counter{};
+			return counter.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+
+	class EntityRange
+	{
+	public:
+		class Iterator
+		{
+		private:
+			EntityID m_id{ nullent };
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = EntityID;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const EntityID*;
+			using reference = EntityID;
+
+			Iterator() = default;
+
+			Iterator(EntityID id)
+				:m_id{ id }
+			{
+			}
+
+			EntityID operator*() const
+			{
+				return m_id;
+			}
+
+			Iterator& operator++()
+			{
+				++m_id;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator out{ *this };
+				++m_id;
+				return out;
+			}
+
+			bool operator==(const Iterator& right) const
+			{
+				return m_id == right.m_id;
+			}
+
+			bool operator!=(const Iterator& right) const
+			{
+				return !(*this == right);
+			}
+		};
+
+	private:
+		EntityID m_first{ nullent };
+		size_t m_count{};
+
+	public:
+		EntityRange() = default;
+
+		EntityRange(EntityID first, size_t count)
+			:m_first{ first }, m_count{ count }
+		{
+		}
+
+		EntityID operator[](size_t index) const
+		{
+			return m_first + static_cast<EntityID>(index);
+		}
+
+		EntityID front() const
+		{
+			return m_first;
+		}
+
+		EntityID back() const
+		{
+			return (*this)[m_count - 1];
+		}
+
+		bool contains(EntityID id) const
+		{
+			return id >= m_first && id - m_first < m_count;
+		}
+
+		size_t size() const
+		{
+			return m_count;
+		}
+
+		bool empty() const
+		{
+			return m_count == 0;
+		}
+
+		Iterator begin() const
+		{
+			return Iterator{ m_first };
+		}
+
+		Iterator end() const
+		{
+			return Iterator{ (*this)[m_count] };
+		}
+	};
+
 
 	template<typename T>
 	class ObserverPtr
@@ -49,27 +218,13 @@ namespace CECS
 		{
 		}
 
-		ObserverPtr(const ObserverPtr& ptr)
-			:m_ptr{ ptr.m_ptr }
-		{
-		}
+		ObserverPtr(const ObserverPtr& ptr) = default;
 
-		ObserverPtr(ObserverPtr&& ptr) noexcept
-			:m_ptr{ ptr.m_ptr }
-		{
-		}
+		ObserverPtr(ObserverPtr&& ptr) noexcept = default;
 
-		ObserverPtr& operator=(const ObserverPtr& ptr)
-		{
-			m_ptr = ptr.m_ptr;
-			return *this;
-		}
+		ObserverPtr& operator=(const ObserverPtr& ptr) = default;
 
-		ObserverPtr& operator=(ObserverPtr&& ptr) noexcept
-		{
-			m_ptr = ptr.m_ptr;
-			return *this;
-		}
+		ObserverPtr& operator=(ObserverPtr&& ptr) noexcept = default;
 
 		ObserverPtr& operator=(T* ptr)
 		{
@@ -87,11 +242,21 @@ namespace CECS
 			return m_ptr;
 		}
 
+		const T* get() const
+		{
+			return m_ptr;
+		}
+
 		T* operator->()
 		{
 			return m_ptr;
 		}
 
+		const T* operator->() const
+		{
+			return m_ptr;
+		}
+
 		const T& operator*() const
 		{
 			return *m_ptr;
@@ -109,1340 +274,4316 @@ namespace CECS
 
 		bool operator==(const ObserverPtr<T>& observePtr) const
 		{
-			return m_ptr == observePtr;
+			return m_ptr == observePtr.m_ptr;
 		}
 
 		bool operator!=(const ObserverPtr<T>& observePtr) const
 		{
-			return m_ptr != observePtr;
+			return m_ptr != observePtr.m_ptr;
 		}
 	};
 
 
-	class Signature
+#ifdef CECS_SINGLE_THREADED
+	class SharedMutex
 	{
 	public:
-		using Bitset = std::bitset<BITSET_SIZE>;
-
-	private:
-		using DynamicBitset = std::map<Index, Bitset>;
+		SharedMutex() = default;
 
-		DynamicBitset m_bits;
+		SharedMutex(const SharedMutex& mutex) = delete;
 
-	public:
-		Signature() = default;
+		SharedMutex& operator=(const SharedMutex& mutex) = delete;
 
-		bool check(ComponentID id) const
+		void lock()
 		{
-			return m_bits.at(id / BITSET_SIZE)[id % BITSET_SIZE];
 		}
 
-		void set(ComponentID id, bool value = true)
+		bool try_lock()
 		{
-			auto check{ m_bits.find(id / BITSET_SIZE) };
-
-			if (check == m_bits.end())
-			{
-				m_bits[id / BITSET_SIZE] = Bitset{};
-			}
-
-			Bitset& bitsetBlock{ m_bits[id / BITSET_SIZE] };
-			bitsetBlock.set(id % BITSET_SIZE, value);
-
-			if (!bitsetBlock.any())
-			{
-				m_bits.erase(id / BITSET_SIZE);
-			}
+			return true;
 		}
 
-		bool any() const
+		void unlock()
 		{
-			return !m_bits.empty();
 		}
 
-		Bitset& bitset(Index index)
+		void lock_shared()
 		{
-			return m_bits[index];
 		}
 
-		const Bitset& bitset(Index index) const
+		bool try_lock_shared()
 		{
-			return m_bits.at(index);
+			return true;
 		}
 
-		bool subset(const Signature& aim) const
+		void unlock_shared()
 		{
-			for (auto& pair : m_bits)
-			{
-				auto check{ aim.m_bits.find(pair.first) };
-				if (check == aim.m_bits.end() ||
-					(bitset(pair.first) & aim.bitset(pair.first)) != bitset(pair.first))
-				{
-					return false;
-				}
-			}
-			return true;
 		}
+	};
+#else
+	class SharedMutex
+	{
+	private:
+		static constexpr uint32_t WRITER{ uint32_t{ 1 } << 31 };
 
-		bool anyMatch(const Signature& aim) const
+		std::atomic<uint32_t> m_state{};
+
+	public:
+		SharedMutex() = default;
+
+		SharedMutex(const SharedMutex& mutex) = delete;
+
+		SharedMutex& operator=(const SharedMutex& mutex) = delete;
+
+		void lock()
 		{
-			for (auto& pair : aim.m_bits)
+			while (m_state.fetch_or(WRITER, std::memory_order_acquire) & WRITER)
 			{
-				auto check{ m_bits.find(pair.first) };
-				if (check != m_bits.end() &&
-					(bitset(pair.first) & aim.bitset(pair.first)).any())
+				while (m_state.load(std::memory_order_relaxed) & WRITER)
 				{
-					return true;
+					std::this_thread::yield();
 				}
 			}
-			return false;
-		}
-
-		bool operator==(const Signature& right) const
-		{
-			for (auto& pair : right.m_bits)
+			while (m_state.load(std::memory_order_acquire) != WRITER)
 			{
-				auto check{ m_bits.find(pair.first) };
-				if (check == m_bits.end() ||
-					(bitset(pair.first) == right.bitset(pair.first)))
-				{
-					return true;
-				}
+				std::this_thread::yield();
 			}
-			return false;
 		}
 
-		bool operator!=(const Signature& right) const
+		bool try_lock()
 		{
-			return !(*this == right);
+			uint32_t expected{};
+			return m_state.compare_exchange_strong(expected, WRITER, std::memory_order_acquire, std::memory_order_relaxed);
 		}
 
-		void operator+=(const Signature& signature)
+		void unlock()
 		{
-			for (const auto& pair : signature.m_bits)
-			{
-				auto result{ m_bits.find(pair.first) };
-				if (result != m_bits.end())
-				{
-					result->second = result->second | pair.second;
-				}
-				else
-				{
-					m_bits[pair.first] = pair.second;
-				}
-			}
+			m_state.fetch_and(~WRITER, std::memory_order_release);
 		}
 
-		std::vector<ComponentID> getComponents() const
+		void lock_shared()
 		{
-			std::vector<ComponentID> out;
-			for (auto& pair : m_bits)
+			while (m_state.fetch_add(1, std::memory_order_acquire) & WRITER)
 			{
-				for (ComponentID index{}; index < BITSET_SIZE; ++index)
+				m_state.fetch_sub(1, std::memory_order_relaxed);
+				while (m_state.load(std::memory_order_relaxed) & WRITER)
 				{
-					if (pair.second.test(index))
-					{
-						out.push_back(pair.first * BITSET_SIZE + index);
-					}
+					std::this_thread::yield();
 				}
 			}
-
-			return out;
 		}
 
-		const DynamicBitset& getBitsets() const
+		bool try_lock_shared()
 		{
-			return m_bits;
+			if (m_state.fetch_add(1, std::memory_order_acquire) & WRITER)
+			{
+				m_state.fetch_sub(1, std::memory_order_relaxed);
+				return false;
+			}
+			return true;
 		}
 
-	};
-
-
-	inline constexpr size_t ARRAY_BYTES{ 500000 };
-
-	template<typename T>
-	class RigitAllocator : public std::allocator<T>
-	{
-	public:
-		size_t chunkSize()
+		void unlock_shared()
 		{
-			size_t size{ ARRAY_BYTES / sizeof(T) };
-			if (size == 0) {
-				return 1;
-			}
-			return size;
+			m_state.fetch_sub(1, std::memory_order_release);
 		}
 	};
+#endif
 
 
-	template<typename T>
-	class RigitIterator
+	class JobCounter
 	{
 	private:
-		using MultiArray = T**;
+		std::atomic<size_t> m_count{};
+		std::atomic<bool> m_failed{};
+		std::exception_ptr m_exception;
 
-		MultiArray m_arrays;
-		size_t m_arraySize;
-		size_t m_itemIndex;
+		friend class JobSystem;
 
 	public:
-		RigitIterator(MultiArray arrays, size_t arraySize, size_t itemIndex)
-			:m_arrays{ arrays }, m_arraySize{ arraySize }, m_itemIndex{ itemIndex }
-		{
-		}
+		JobCounter() = default;
 
-		T& operator*()
-		{
-			return m_arrays[m_itemIndex / m_arraySize][m_itemIndex % m_arraySize];
-		}
+		JobCounter(const JobCounter& counter) = delete;
 
-		const T& operator*() const
+		JobCounter& operator=(const JobCounter& counter) = delete;
+
+		bool done() const
 		{
-			return m_arrays[m_itemIndex / m_arraySize][m_itemIndex % m_arraySize];
+			return m_count.load(std::memory_order_acquire) == 0;
 		}
 
-		RigitIterator& operator++()
+		size_t pending() const
 		{
-			++m_itemIndex;
-			return *this;
+			return m_count.load(std::memory_order_acquire);
 		}
 
-		bool operator==(const RigitIterator& right) const
+	private:
+		void fail(std::exception_ptr exception)
 		{
-			return m_itemIndex == right.m_itemIndex;
+			if (!m_failed.exchange(true, std::memory_order_acq_rel))
+			{
+				m_exception = std::move(exception);
+			}
 		}
 
-		bool operator!=(const RigitIterator& right) const
+		void rethrow()
 		{
-			return m_itemIndex != right.m_itemIndex;
+			if (!m_failed.load(std::memory_order_acquire))
+			{
+				return;
+			}
+			std::exception_ptr exception{ std::exchange(m_exception, nullptr) };
+			m_failed.store(false, std::memory_order_relaxed);
+			std::rethrow_exception(exception);
 		}
 	};
 
-	template<typename T, typename Allocator = RigitAllocator<T>>
-	class RigitArray
+	class JobContext
 	{
 	private:
-		using Array = T*;
-		using ArrayContainer = std::vector<Array>;
+		const std::vector<size_t>* m_path{};
+		size_t m_index{};
+		size_t m_forks{};
+		size_t m_serial{ nextSerial() };
+		JobContext* m_previous{ t_current };
 
-		ArrayContainer m_arrays;
-		Allocator m_allocator;
-		size_t m_arraySize;
-		size_t m_itemCount{};
+		static inline thread_local JobContext* t_current{};
 
 	public:
-		RigitArray() 
-			:m_arraySize{ m_allocator.chunkSize() }
+		JobContext()
 		{
+			t_current = this;
 		}
 
-		RigitArray(const RigitArray& rigitArray) : RigitArray(std::move(rigitArray.copy()))
+		JobContext(const std::vector<size_t>& path, size_t index)
+			:m_path{ &path }, m_index{ index }
 		{
+			t_current = this;
 		}
 
-		RigitArray(RigitArray&& rigitArray) noexcept :
-			m_arrays{ std::move(rigitArray.m_arrays) },
-			m_allocator{ std::move(rigitArray.m_allocator) },
-			m_arraySize{ rigitArray.m_arraySize },
-			m_itemCount{ rigitArray.m_itemCount }
-		{
-			rigitArray.m_itemCount = 0;
-		}
+		JobContext(const JobContext& context) = delete;
 
-		RigitArray& operator=(const RigitArray& rigitArray)
-		{
-			clear();
-			*this = std::move(rigitArray.copy());
-			return *this;
-		}
+		JobContext& operator=(const JobContext& context) = delete;
 
-		RigitArray& operator=(RigitArray&& rigitArray) noexcept
+		~JobContext()
 		{
-			clear();
-			m_arrays = std::move(rigitArray.m_arrays);
-			m_allocator = std::move(rigitArray.m_allocator);
-			m_arraySize = rigitArray.m_arraySize;
-			m_itemCount = rigitArray.m_itemCount;
-			rigitArray.m_itemCount = 0;
-			return *this;
+			t_current = m_previous;
 		}
 
-		virtual ~RigitArray()
+		static JobContext& current()
 		{
-			clear();
+			if (!t_current)
+			{
+				static thread_local JobContext root;
+				t_current = &root;
+			}
+			return *t_current;
 		}
 
-		void pushBack(const T& item)
+		size_t getSerial() const
 		{
-			pushBack(T{ item });
+			return m_serial;
 		}
 
-		void pushBack(T&& item)
+		size_t getForks() const
 		{
-			increaseCapacity(m_itemCount + 1);
-			constuct(m_itemCount, std::move(item));
-			++m_itemCount;
+			return m_forks;
 		}
 
-		void popBack()
+		std::vector<size_t> getLane() const
 		{
-			destroy(m_itemCount - 1);
-			--m_itemCount;
-			decreaseCapacity(m_itemCount);
+			return getPath(2 * m_forks);
 		}
 
-		T& get(size_t index)
+		std::vector<size_t> fork()
 		{
-			return m_arrays[index / m_arraySize][index % m_arraySize];
+			return getPath(2 * m_forks++ + 1);
 		}
 
-		const T& get(size_t index) const
+	private:
+		static size_t nextSerial()
 		{
-			return m_arrays[index / m_arraySize][index % m_arraySize];
+			static std::atomic<size_t> next{ 1 };
+			return next.fetch_add(1, std::memory_order_relaxed);
 		}
 
-		void set(size_t index, const T& item)
+		std::vector<size_t> getPath(size_t segment) const
 		{
-			get(index) = item;
+			std::vector<size_t> out;
+			if (m_path)
+			{
+				out.reserve(m_path->size() + 2);
+				out.assign(m_path->begin(), m_path->end());
+				out.push_back(m_index);
+			}
+			out.push_back(segment);
+			return out;
 		}
+	};
 
-		void set(size_t index, T&& item)
-		{
-			get(index) = std::move(item);
-		}
+	class JobSystem
+	{
+	private:
+		using Job = std::function<void()>;
 
-		T& operator[](size_t index)
+		struct WorkQueue
 		{
-			return get(index);
-		}
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
 
-		const T& operator[](size_t index) const
+		using QueueContainer = std::vector<std::unique_ptr<WorkQueue>>;
+
+		QueueContainer m_queues;
+		std::vector<std::thread> m_threads;
+		std::atomic<size_t> m_queued{};
+		std::atomic<size_t> m_sleepers{};
+		std::atomic<bool> m_running{ true };
+		std::mutex m_sleep;
+		std::condition_variable m_wake;
+
+		static inline thread_local ObserverPtr<JobSystem> t_system;
+		static inline thread_local size_t t_queue{};
+
+	public:
+		JobSystem(size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1))
 		{
-			return get(index);
+			for (size_t queue{}; queue < std::max<size_t>(threads, 1); ++queue)
+			{
+				m_queues.push_back(std::make_unique<WorkQueue>());
+			}
+			for (size_t queue{ 1 }; queue < m_queues.size(); ++queue)
+			{
+				m_threads.emplace_back([this, queue]() { work(queue); });
+			}
 		}
 
-		T& back()
+		JobSystem(const JobSystem& jobs) = delete;
+
+		JobSystem& operator=(const JobSystem& jobs) = delete;
+
+		~JobSystem()
 		{
-			return get(m_itemCount - 1);
+			{
+				std::lock_guard<std::mutex> lock{ m_sleep };
+				m_running = false;
+			}
+			m_wake.notify_all();
+			for (std::thread& thread : m_threads)
+			{
+				thread.join();
+			}
 		}
 
-		const T& back() const
+		static JobSystem& instance()
 		{
-			return get(m_itemCount - 1);
+			static JobSystem jobs;
+
+			return jobs;
 		}
 
-		void swap(size_t left, size_t right)
+		size_t size() const
 		{
-			std::swap(get(left), get(right));
+			return m_queues.size();
 		}
 
-		void clear()
+		template<typename Function>
+		void submit(Function&& function, JobCounter& counter)
 		{
-			for (size_t index{}; index < m_itemCount; ++index)
+			counter.m_count.fetch_add(1, std::memory_order_relaxed);
+			WorkQueue& queue{ *m_queues[ownQueue()] };
 			{
-				destroy(index);
+				std::lock_guard<std::mutex> lock{ queue.mutex };
+				queue.jobs.emplace_back([function{ std::forward<Function>(function) }, &counter, path{ JobContext::current().fork() }]() mutable
+				{
+						{
+							JobContext context{ path, 0 };
+						try
+						{
+						function();
+						}
+						catch (...)
+						{
+							counter.fail(std::current_exception());
+						}
+						}
+						counter.m_count.fetch_sub(1, std::memory_order_release);
+						});
+				m_queued.fetch_add(1);
+				}
+			wake();
 			}
-			decreaseCapacity(0);
-			m_itemCount = 0;
-		}
 
-		size_t size() const
-		{
-			return m_itemCount;
+		void wait(JobCounter& counter)
+			{
+			while (!counter.done())
+			{
+				if (!runOne(ownQueue()))
+				{
+					std::this_thread::yield();
+				}
+			}
+			counter.rethrow();
 		}
 
-		size_t capacity() const
+		template<typename Function>
+		void dispatch(size_t count, Function&& function)
 		{
-			return m_arraySize * m_arrays.size();
-		}
+			if (count == 0)
+			{
+				return;
+			}
 
-		bool empty() const
-		{
-			return !static_cast<bool>(m_itemCount);
+			JobCounter counter;
+			counter.m_count.store(count, std::memory_order_relaxed);
+			std::vector<size_t> path{ JobContext::current().fork() };
+			WorkQueue& queue{ *m_queues[ownQueue()] };
+			{
+				std::lock_guard<std::mutex> lock{ queue.mutex };
+				for (size_t job{}; job < count; ++job)
+				{
+					queue.jobs.emplace_back([&function, &counter, &path, job]()
+						{
+							{
+								JobContext context{ path, job };
+							try
+							{
+							function(job);
+							}
+							catch (...)
+							{
+								counter.fail(std::current_exception());
+							}
+							}
+							counter.m_count.fetch_sub(1, std::memory_order_release);
+						});
+				}
+				m_queued.fetch_add(count);
+			}
+			wake();
+			wait(counter);
 		}
 
-		RigitIterator<T> begin()
+		template<typename Function>
+		void parallelFor(size_t count, size_t grain, Function&& function)
 		{
-			return RigitIterator<T>{m_arrays.data(), m_arraySize, 0};
+			grain = std::max<size_t>(grain, 1);
+			dispatch((count + grain - 1) / grain, [&function, count, grain](size_t job)
+				{
+					size_t first{ job * grain };
+					function(first, std::min(first + grain, count));
+				});
 		}
 
-		RigitIterator<T> end()
+		template<typename Function>
+		void parallelFor(size_t count, Function&& function)
 		{
-			return RigitIterator<T>{nullptr, 0, m_itemCount};
+			parallelFor(count, count / (size() * 4) + 1, std::forward<Function>(function));
 		}
 
-		RigitArray copy() const
+	private:
+		void wake()
 		{
-			RigitArray<T, Allocator> out;
-			for (size_t index{}; index < m_itemCount; ++index)
+			if (m_sleepers.load() == 0)
+			{
+				return;
+			}
 			{
-				out.pushBack(get(index));
+				std::lock_guard<std::mutex> lock{ m_sleep };
 			}
-			return out;
+			m_wake.notify_all();
 		}
 
-	private:
-		void constuct(size_t index, T&& item)
+		size_t ownQueue() const
 		{
-			std::allocator_traits<Allocator>::construct(m_allocator, &get(index), std::move(item));
+			return t_system.get() == this ? t_queue : 0;
 		}
 
-		void destroy(size_t index)
+		bool runOne(size_t own)
 		{
-			std::allocator_traits<Allocator>::destroy(m_allocator, &get(index));
+			Job job;
+			if (!pop(own, job))
+			{
+				return false;
+			}
+			job();
+			return true;
 		}
 
-		void increaseCapacity(size_t newCapacity)
+		bool pop(size_t own, Job& job)
 		{
-			while (newCapacity > capacity())
+			if (m_queued.load(std::memory_order_acquire) == 0)
 			{
-				m_arrays.push_back(std::allocator_traits<Allocator>::allocate(m_allocator, m_arraySize));
+				return false;
 			}
-		}
 
-		void decreaseCapacity(size_t newCapacity)
-		{
-			if (newCapacity)
 			{
-				newCapacity += m_arraySize;
+				WorkQueue& queue{ *m_queues[own] };
+				std::lock_guard<std::mutex> lock{ queue.mutex };
+				if (!queue.jobs.empty())
+				{
+					job = std::move(queue.jobs.back());
+					queue.jobs.pop_back();
+					m_queued.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
 			}
 
-			while (capacity() > newCapacity)
+			for (size_t offset{ 1 }; offset < m_queues.size(); ++offset)
 			{
-				Array removal{ m_arrays.back() };
-				std::allocator_traits<Allocator>::deallocate(m_allocator, removal, m_arraySize);
-				m_arrays.pop_back();
+				WorkQueue& victim{ *m_queues[(own + offset) % m_queues.size()] };
+				std::lock_guard<std::mutex> lock{ victim.mutex };
+				if (!victim.jobs.empty())
+				{
+					job = std::move(victim.jobs.front());
+					victim.jobs.pop_front();
+					m_queued.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void work(size_t queue)
+		{
+			t_system = this;
+			t_queue = queue;
+			while (true)
+			{
+				if (runOne(queue))
+				{
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock{ m_sleep };
+				++m_sleepers;
+				m_wake.wait(lock, [this]() { return !m_running || m_queued.load() != 0; });
+				--m_sleepers;
+				if (!m_running)
+				{
+					return;
+				}
 			}
 		}
 	};
 
 
-	template<typename T>
-	class Indexer
+	class Signature
 	{
+	public:
+		using Word = uint64_t;
+
+		static constexpr size_t WORDS{ (MAX_COMPONENTS + BITSET_SIZE - 1) / BITSET_SIZE };
+
 	private:
-		using EmptyIndexContainer = RigitArray<T>;
+		using WordArray = std::array<Word, WORDS>;
 
-		T m_nextIndex;
-		EmptyIndexContainer m_emptyIndices;
+		WordArray m_words{};
 
 	public:
-		Indexer(T start = 0)
-			:m_nextIndex{ start }
+		Signature() = default;
+
+		bool check(ComponentID id) const
 		{
+			return id < MAX_COMPONENTS && (m_words[id / BITSET_SIZE] >> (id % BITSET_SIZE)) & 1;
 		}
 
-		T createIndex()
+		void set(ComponentID id, bool value = true)
 		{
-			if (m_emptyIndices.empty())
+			Word mask{ Word{ 1 } << (id % BITSET_SIZE) };
+			Word& word{ m_words[id / BITSET_SIZE] };
+			word = value ? (word | mask) : (word & ~mask);
+		}
+
+		bool any() const
+		{
+			Word out{};
+			for (Word word : m_words)
 			{
-				return m_nextIndex++;
+				out |= word;
 			}
+			return out != 0;
+		}
 
-			T out{ m_emptyIndices.back() };
-			m_emptyIndices.popBack();
-
+		size_t count() const
+		{
+			size_t out{};
+			for (Word word : m_words)
+			{
+				out += std::popcount(word);
+			}
 			return out;
 		}
 
-		void releaseIndex(T index)
+		Word word(Index index) const
 		{
-			m_emptyIndices.pushBack(index);
+			return m_words[index];
 		}
 
-	};
-
-
-	class IComponentArray;
-	using ComponentArrayBase = std::unique_ptr<IComponentArray>;
-
-	class IComponentArray
-	{
-	public:
-		virtual ~IComponentArray() = default;
-
-		virtual void removeComponent() = 0;
-
-		virtual void swapComponents(Index left, Index right) = 0;
+		bool subset(const Signature& aim) const
+		{
+			Word out{};
+			for (size_t index{}; index < WORDS; ++index)
+			{
+				out |= m_words[index] & ~aim.m_words[index];
+				}
+			return out == 0;
+		}
 
-		virtual void carryFrom(IComponentArray& origin, Index index) = 0;
+		bool anyMatch(const Signature& aim) const
+		{
+			Word out{};
+			for (size_t index{}; index < WORDS; ++index)
+			{
+				out |= m_words[index] & aim.m_words[index];
+				}
+			return out != 0;
+		}
 
-		virtual void copyFrom(const IComponentArray& origin, Index index) = 0;
+		bool operator==(const Signature& right) const
+		{
+			return m_words == right.m_words;
+		}
 
-		virtual ComponentArrayBase copy() const = 0;
+		bool operator!=(const Signature& right) const
+		{
+			return !(*this == right);
+		}
 
-	};
+		void operator+=(const Signature& signature)
+		{
+			for (size_t index{}; index < WORDS; ++index)
+			{
+				m_words[index] |= signature.m_words[index];
+			}
+		}
 
-	template<typename Component>
-	class ComponentArray : public IComponentArray
-	{
-	private:
-		RigitArray<Component> components;
+		std::vector<ComponentID> getComponents() const
+		{
+			std::vector<ComponentID> out;
+			out.reserve(count());
+			for (size_t index{}; index < WORDS; ++index)
+			{
+				for (Word word{ m_words[index] }; word; word &= word - 1)
+				{
+					out.push_back(static_cast<ComponentID>(index * BITSET_SIZE + std::countr_zero(word)));
+				}
+			}
 
-	public:
-		ComponentArray() = default;
+			return out;
+		}
 
-		ComponentArray(const RigitArray<Component>& rigitArray) : components{ rigitArray }
+		const WordArray& getWords() const
 		{
+			return m_words;
 		}
 
-		ComponentArray(const ComponentArray& componentArray) = default;
+	};
 
-		ComponentArray(ComponentArray&& componentArray) = default;
+	static_assert(std::is_trivially_copyable_v<Signature>);
 
-		ComponentArray& operator=(const ComponentArray& componentArray) = default;
 
-		ComponentArray& operator=(ComponentArray&& componentArray) = default;
+#ifdef CECS_CHUNK_ALIGNMENT
+	inline constexpr size_t CHUNK_ALIGNMENT{ CECS_CHUNK_ALIGNMENT };
+#else
+	inline constexpr size_t CHUNK_ALIGNMENT{ 64 };
+#endif
 
-		~ComponentArray() = default;
+	inline constexpr size_t HUGE_PAGE_BYTES{ 2 * 1024 * 1024 };
 
-		void addComponent(const Component& component)
+	struct ChunkTraits
+	{
+		static constexpr bool hugePage([[maybe_unused]] size_t bytes)
 		{
-			components.pushBack(Component{ component });
+#if defined(CECS_HUGE_PAGES) && defined(__linux__)
+			return bytes >= HUGE_PAGE_BYTES / 2;
+#else
+			return false;
+#endif
 		}
 
-		void addComponent(Component&& component)
+		static constexpr size_t size(size_t bytes)
 		{
-			components.pushBack(std::move(component));
+			if (hugePage(bytes))
+			{
+				return (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+			}
+			return bytes;
 		}
 
-		void removeComponent() override
+		static constexpr size_t alignment(size_t bytes, size_t alignment)
 		{
-			components.popBack();
+			if (hugePage(bytes))
+			{
+				return HUGE_PAGE_BYTES;
+			}
+			return alignment;
 		}
 
-		Component& getComponent(Index index)
+		static void* allocate(size_t bytes, size_t alignment)
 		{
-			return components.get(index);
+			void* out{ ::operator new(size(bytes), std::align_val_t{ ChunkTraits::alignment(bytes, alignment) }) };
+#if defined(CECS_HUGE_PAGES) && defined(__linux__)
+			if (hugePage(bytes))
+			{
+				madvise(out, size(bytes), MADV_HUGEPAGE);
+			}
+#endif
+			return out;
 		}
 
-		const Component& getComponent(Index index) const
+		static void deallocate(void* chunk, size_t bytes, size_t alignment)
 		{
-			return components.get(index);
+			::operator delete(chunk, size(bytes), std::align_val_t{ ChunkTraits::alignment(bytes, alignment) });
 		}
+	};
 
-		void setComponent(Index index, Component&& component)
-		{
-			components.set(index, std::move(component));
-		}
+	struct ArenaStatistics
+	{
+		size_t systemAllocations{};
+		size_t systemDeallocations{};
+		size_t reusedChunks{};
+		size_t recycledChunks{};
+		size_t cachedChunks{};
+		size_t cachedBytes{};
+		size_t liveChunks{};
+		size_t liveBytes{};
+	};
 
-		void swapComponents(Index left, Index right) override
+	class ChunkArena
+	{
+	private:
+		using FreeList = std::vector<void*>;
+		using FreeListContainer = std::unordered_map<size_t, FreeList>;
+
+		FreeListContainer m_freeLists;
+		ArenaStatistics m_statistics;
+		size_t m_cacheLimit{ std::numeric_limits<size_t>::max() };
+		mutable std::mutex m_mutex;
+
+	public:
+		ChunkArena() = default;
+
+		ChunkArena(const ChunkArena& arena) = delete;
+
+		ChunkArena& operator=(const ChunkArena& arena) = delete;
+
+		~ChunkArena()
 		{
-			components.swap(left, right);
+			trim();
 		}
 
-		void carryFrom(IComponentArray& origin, Index index) override
+		void* allocate(size_t bytes, size_t alignment)
 		{
-			addComponent(std::move(static_cast<ComponentArray<Component>&>(origin).getComponent(index)));
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			++m_statistics.liveChunks;
+			m_statistics.liveBytes += bytes;
+
+			auto found{ m_freeLists.find(key(bytes, alignment)) };
+			if (found != m_freeLists.end() && !found->second.empty())
+			{
+				void* out{ found->second.back() };
+				found->second.pop_back();
+				++m_statistics.reusedChunks;
+				--m_statistics.cachedChunks;
+				m_statistics.cachedBytes -= bytes;
+				return out;
+			}
+
+			++m_statistics.systemAllocations;
+			return ChunkTraits::allocate(bytes, alignment);
 		}
 
-		void copyFrom(const IComponentArray& origin, Index index) override
+		void deallocate(void* chunk, size_t bytes, size_t alignment)
 		{
-			addComponent(Component{ static_cast<const ComponentArray<Component>&>(origin).getComponent(index) });
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			--m_statistics.liveChunks;
+			m_statistics.liveBytes -= bytes;
+
+			if (m_statistics.cachedBytes + bytes > m_cacheLimit)
+			{
+				++m_statistics.systemDeallocations;
+				ChunkTraits::deallocate(chunk, bytes, alignment);
+				return;
+			}
+
+			m_freeLists[key(bytes, alignment)].push_back(chunk);
+			++m_statistics.recycledChunks;
+			++m_statistics.cachedChunks;
+			m_statistics.cachedBytes += bytes;
 		}
 
-		ComponentArrayBase copy() const override
+		void trim()
 		{
-			return std::make_unique<ComponentArray<Component>>(ComponentArray<Component>{components});
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			for (auto& pair : m_freeLists)
+			{
+				size_t bytes{ pair.first & BYTES_MASK };
+				size_t alignment{ size_t{ 1 } << (pair.first >> ALIGNMENT_SHIFT) };
+				for (void* chunk : pair.second)
+				{
+					ChunkTraits::deallocate(chunk, bytes, alignment);
+					++m_statistics.systemDeallocations;
+				}
+			}
+			m_freeLists.clear();
+			m_statistics.cachedChunks = 0;
+			m_statistics.cachedBytes = 0;
 		}
 
-		size_t size() const
+		void setCacheLimit(size_t bytes)
 		{
-			return components.size();
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_cacheLimit = bytes;
 		}
 
-		bool empty() const
+		size_t getCacheLimit() const
 		{
-			return static_cast<bool>(components.size());
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			return m_cacheLimit;
 		}
 
-		RigitIterator<Component> begin()
+		ArenaStatistics getStatistics() const
 		{
-			return components.begin();
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			return m_statistics;
 		}
 
-		RigitIterator<Component> end()
+	private:
+		static constexpr size_t ALIGNMENT_SHIFT{ 58 };
+		static constexpr size_t BYTES_MASK{ (size_t{ 1 } << ALIGNMENT_SHIFT) - 1 };
+
+		static size_t key(size_t bytes, size_t alignment)
 		{
-			return components.end();
+			return bytes | (static_cast<size_t>(std::countr_zero(alignment)) << ALIGNMENT_SHIFT);
 		}
-
 	};
 
 
-	template<typename T>
-	struct Hash
-	{
-		constexpr size_t operator()(const T& arg) const
+	inline constexpr size_t MIN_ARRAY_BYTES{ 512 };
+#ifdef CECS_HUGE_PAGES
+	inline constexpr size_t ARRAY_BYTES{ HUGE_PAGE_BYTES };
+#else
+	inline constexpr size_t ARRAY_BYTES{ 500000 };
+#endif
+
+	template<typename T, size_t Alignment = CHUNK_ALIGNMENT>
+	class RigitAllocator : public std::allocator<T>
+	{
+	private:
+		ObserverPtr<ChunkArena> m_arena;
+
+		template<typename U, size_t OtherAlignment>
+		friend class RigitAllocator;
+
+	public:
+		static constexpr size_t ALIGNMENT{ std::max(Alignment, alignof(T)) };
+
+		template<typename U>
+		struct rebind
+		{
+			using other = RigitAllocator<U, Alignment>;
+		};
+
+		RigitAllocator() = default;
+
+		RigitAllocator(ObserverPtr<ChunkArena> arena) noexcept
+			:m_arena{ arena }
 		{
-			size_t hash{ static_cast<size_t>(reinterpret_cast<std::uintptr_t>(&arg)) };
-			hash = ((hash >> 16) ^ hash) * 0x45d9f3b;
-			hash = ((hash >> 16) ^ hash) * 0x45d9f3b;
-			hash = ((hash >> 16) ^ hash);
-			return hash;
 		}
-	};
 
-	template<>
-	struct Hash<uint32_t>
-	{
-		constexpr uint32_t operator()(uint32_t arg) const
+		template<typename U>
+		RigitAllocator(const RigitAllocator<U, Alignment>& allocator) noexcept
+			:m_arena{ allocator.m_arena }
 		{
-			return arg;
 		}
-	};
 
-	template<>
-	struct Hash<uint16_t>
-	{
-		constexpr uint16_t operator()(uint16_t arg) const
+		T* allocate(size_t count)
 		{
-			return arg;
+			if (m_arena.isValid())
+			{
+				return static_cast<T*>(m_arena->allocate(count * sizeof(T), ALIGNMENT));
+			}
+			return static_cast<T*>(ChunkTraits::allocate(count * sizeof(T), ALIGNMENT));
 		}
-	};
 
-	template<>
-	struct Hash<size_t>
-	{
-		constexpr size_t operator()(size_t arg) const
+		void deallocate(T* chunk, size_t count)
 		{
-			return arg;
+			if (m_arena.isValid())
+			{
+				m_arena->deallocate(chunk, count * sizeof(T), ALIGNMENT);
+				return;
+			}
+			ChunkTraits::deallocate(chunk, count * sizeof(T), ALIGNMENT);
+		}
+
+		ObserverPtr<ChunkArena> getArena() const
+		{
+			return m_arena;
 		}
 	};
 
-	template<>
-	struct Hash<std::string>
+
+	template<typename T>
+	struct RigitLayout
 	{
-		constexpr uint32_t operator()(const std::string& s) const
+		static constexpr size_t FIRST_SIZE{ std::bit_floor(std::max<size_t>(MIN_ARRAY_BYTES / sizeof(T), 1)) };
+		static constexpr size_t MAX_SIZE{ std::max(std::bit_floor(std::max<size_t>(ARRAY_BYTES / sizeof(T), 1)), FIRST_SIZE) };
+		static constexpr size_t FIRST_SHIFT{ static_cast<size_t>(std::countr_zero(FIRST_SIZE)) };
+		static constexpr size_t MAX_SHIFT{ static_cast<size_t>(std::countr_zero(MAX_SIZE)) };
+		static constexpr size_t LEVELS{ MAX_SHIFT - FIRST_SHIFT };
+
+		static constexpr size_t chunkOf(size_t index)
 		{
-			return operator()(s.c_str());
+			if (index < MAX_SIZE)
+			{
+				return std::bit_width(index >> FIRST_SHIFT);
+			}
+			return LEVELS + (index >> MAX_SHIFT);
 		}
 
-		constexpr uint32_t operator()(const char* s) const
+		static constexpr size_t offsetOf(size_t index)
 		{
-			uint32_t hash{};
+			if (index < MAX_SIZE)
+			{
+				return index & ((FIRST_SIZE << (std::max<size_t>(chunkOf(index), 1) - 1)) - 1);
+			}
+			return index & (MAX_SIZE - 1);
+		}
 
-			for (uint32_t index{}; s[index]; ++index)
+		static constexpr size_t chunkStart(size_t chunk)
+		{
+			if (chunk == 0)
 			{
-				hash += (index + 1) * s[index];
+				return 0;
 			}
+			if (chunk <= LEVELS + 1)
+			{
+				return FIRST_SIZE << (chunk - 1);
+			}
+			return (chunk - LEVELS) << MAX_SHIFT;
+		}
 
-			return hash;
+		static constexpr size_t chunkSize(size_t chunk)
+		{
+			if (chunk == 0)
+			{
+				return FIRST_SIZE;
+			}
+			return FIRST_SIZE << std::min(chunk - 1, LEVELS);
 		}
 	};
 
-	template<>
-	struct Hash<Signature>
+	template<typename T>
+	class RigitIterator
 	{
-		size_t operator()(const Signature& signature) const
+	private:
+		using MultiArray = T**;
+		using Layout = RigitLayout<std::remove_const_t<T>>;
+
+		MultiArray m_arrays;
+		size_t m_itemIndex;
+		size_t m_chunk;
+		size_t m_chunkStart;
+		size_t m_chunkEnd;
+
+	public:
+		RigitIterator(MultiArray arrays, size_t itemIndex)
+			:m_arrays{ arrays }, m_itemIndex{ itemIndex }, m_chunk{ Layout::chunkOf(itemIndex) }
 		{
-			size_t out{};
-			for (const auto& pair : signature.getBitsets())
+			m_chunkStart = Layout::chunkStart(m_chunk);
+			m_chunkEnd = Layout::chunkStart(m_chunk + 1);
+		}
+
+		T& operator*()
+		{
+			return m_arrays[m_chunk][m_itemIndex - m_chunkStart];
+		}
+
+		const T& operator*() const
+		{
+			return m_arrays[m_chunk][m_itemIndex - m_chunkStart];
+		}
+
+		RigitIterator& operator++()
+		{
+			++m_itemIndex;
+			if (m_itemIndex == m_chunkEnd)
 			{
-				out += (pair.first + 1) * pair.second.to_ullong();
+				++m_chunk;
+				m_chunkStart = m_chunkEnd;
+				m_chunkEnd = Layout::chunkStart(m_chunk + 1);
 			}
-			return out;
+			return *this;
 		}
-	};
 
+		bool operator==(const RigitIterator& right) const
+		{
+			return m_itemIndex == right.m_itemIndex;
+		}
 
-	using ArrayContainer = std::unordered_map<TypeName, ComponentArrayBase, Hash<std::string>>;
+		bool operator!=(const RigitIterator& right) const
+		{
+			return m_itemIndex != right.m_itemIndex;
+		}
+	};
 
-	class Cluster
+	template<typename T, typename Allocator = RigitAllocator<T>>
+	class RigitArray
 	{
 	private:
-		using EntityMap = std::unordered_map<EntityID, Index, Hash<EntityID>>;
-		using ReverseMap = RigitArray<EntityID>;
+		using Array = T*;
+		using ArrayContainer = std::vector<Array>;
+		using Layout = RigitLayout<T>;
 
 		ArrayContainer m_arrays;
-		EntityMap m_indices;
-		ReverseMap m_reverse;
-		ClusterID m_id{ nullcluster };
-		Signature m_signature;
-
-		friend struct ClusterTraits;
+		Allocator m_allocator;
+		size_t m_itemCount{};
+		size_t m_reserved{};
 
 	public:
-		template<typename... Args>
-		struct Cache
+		RigitArray() = default;
+
+		RigitArray(const Allocator& allocator)
+			:m_allocator{ allocator }
 		{
-		private:
-			std::vector<ObserverPtr<IComponentArray>> m_arrays;
-			ObserverPtr<RigitArray<EntityID>> m_ids;
+		}
 
-		public:
-			Cache() = default;
+		RigitArray(const RigitArray& rigitArray) : RigitArray(std::move(rigitArray.copy()))
+		{
+		}
 
-			Cache(Cluster& cluster, const std::vector<TypeName>& names)
-				:m_ids{ &cluster.m_reverse }
-			{
-				for (auto& name : names)
-				{
-					m_arrays.push_back(cluster.m_arrays[name].get());
-				}
-			}
+		RigitArray(RigitArray&& rigitArray) noexcept :
+			m_arrays{ std::move(rigitArray.m_arrays) },
+			m_allocator{ std::move(rigitArray.m_allocator) },
+			m_itemCount{ rigitArray.m_itemCount },
+			m_reserved{ rigitArray.m_reserved }
+		{
+			rigitArray.m_itemCount = 0;
+			rigitArray.m_reserved = 0;
+		}
 
-			std::tuple<EntityID, Args&...> getItems(Index index)
+		RigitArray& operator=(const RigitArray& rigitArray)
+		{
+			clear();
+			*this = std::move(rigitArray.copy());
+			return *this;
+		}
+
+		RigitArray& operator=(RigitArray&& rigitArray) noexcept
+		{
+			m_reserved = 0;
+			clear();
+			m_arrays = std::move(rigitArray.m_arrays);
+			m_allocator = std::move(rigitArray.m_allocator);
+			m_itemCount = rigitArray.m_itemCount;
+			m_reserved = rigitArray.m_reserved;
+			rigitArray.m_itemCount = 0;
+			rigitArray.m_reserved = 0;
+			return *this;
+		}
+
+		virtual ~RigitArray()
+		{
+			m_reserved = 0;
+			clear();
+		}
+
+		void pushBack(const T& item)
+		{
+			increaseCapacity(m_itemCount + 1);
+			std::allocator_traits<Allocator>::construct(m_allocator, &get(m_itemCount), item);
+			++m_itemCount;
+		}
+
+		void pushBack(T&& item)
+		{
+			increaseCapacity(m_itemCount + 1);
+			constuct(m_itemCount, std::move(item));
+			++m_itemCount;
+		}
+
+		void popBack()
+		{
+			destroy(m_itemCount - 1);
+			--m_itemCount;
+			decreaseCapacity(m_itemCount);
+		}
+
+		void eraseSwapBack(size_t index)
+		{
+			if (index + 1 != m_itemCount)
 			{
-				size_t arrayIndex{ m_arrays.size() };
-				return std::tuple<EntityID, Args&...>(m_ids->get(index), (--arrayIndex, get<Args>(m_arrays[arrayIndex], index))...);
+				get(index) = std::move(back());
 			}
+			popBack();
+		}
 
-		private:
-			template <typename T>
-			T& get(ObserverPtr<IComponentArray>& base, Index index)
+		void eraseSwapBack(const std::vector<size_t>& sortedIndices)
+		{
+			for (auto index{ sortedIndices.rbegin() }; index != sortedIndices.rend(); ++index)
 			{
-				return static_cast<ComponentArray<T>*>(base.get())->getComponent(index);
+				eraseSwapBack(*index);
 			}
-		};
+		}
 
-	public:
-		Cluster(ClusterID id, const Signature& signature)
-			:m_id{ id }, m_signature{ signature }
+		T& get(size_t index)
 		{
+			return m_arrays[Layout::chunkOf(index)][Layout::offsetOf(index)];
 		}
 
-		Cluster(const Cluster& cluster)
-			:m_indices{ cluster.m_indices }, m_reverse{ cluster.m_reverse }, m_signature{ cluster.m_signature }
+		const T& get(size_t index) const
 		{
-			for (auto& arrayPair : cluster.m_arrays)
-			{
-				m_arrays[arrayPair.first] = arrayPair.second->copy();
-			}
+			return m_arrays[Layout::chunkOf(index)][Layout::offsetOf(index)];
 		}
 
-		Cluster(Cluster&& cluster) noexcept = default;
+		size_t contiguous(size_t index) const
+		{
+			return std::min(Layout::chunkStart(Layout::chunkOf(index) + 1), m_itemCount) - index;
+		}
 
-		Cluster& operator=(const Cluster& cluster)
+		void set(size_t index, const T& item)
 		{
-			m_indices = cluster.m_indices;
-			m_reverse = cluster.m_reverse;
-			m_signature = cluster.m_signature;
+			get(index) = item;
+		}
 
-			m_arrays.clear();
-			for (auto& arrayPair : cluster.m_arrays)
-			{
-				m_arrays[arrayPair.first] = arrayPair.second->copy();
-			}
-			return *this;
+		void set(size_t index, T&& item)
+		{
+			get(index) = std::move(item);
 		}
 
-		Cluster& operator=(Cluster&& cluster) noexcept
+		T& operator[](size_t index)
 		{
-			m_arrays = std::move(cluster.m_arrays);
-			m_indices = std::move(cluster.m_indices);
-			m_reverse = std::move(cluster.m_reverse);
-			m_signature = std::move(cluster.m_signature);
-			m_id = cluster.m_id;
-			cluster.m_id = nullcluster;
-			return *this;
+			return get(index);
 		}
 
-		~Cluster() = default;
+		const T& operator[](size_t index) const
+		{
+			return get(index);
+		}
 
-		ClusterID getID() const
+		T& back()
 		{
-			return m_id;
+			return get(m_itemCount - 1);
 		}
 
-		void setID(ClusterID id)
+		const T& back() const
 		{
-			m_id = id;
+			return get(m_itemCount - 1);
+		}
+
+		void swap(size_t left, size_t right)
+		{
+			std::swap(get(left), get(right));
+		}
+
+		void append(const RigitArray& origin, size_t first, size_t count)
+		{
+			increaseCapacity(m_itemCount + count);
+			while (count)
+			{
+				size_t run{ std::min({ count, origin.contiguous(first), chunkRemainder(m_itemCount) }) };
+				const T* source{ &origin.get(first) };
+				T* destination{ &get(m_itemCount) };
+				if constexpr (std::is_trivially_copyable_v<T>)
+				{
+					std::memcpy(destination, source, run * sizeof(T));
+				}
+				else
+				{
+					std::uninitialized_copy_n(source, run, destination);
+				}
+				m_itemCount += run;
+				first += run;
+				count -= run;
+			}
+		}
+
+		void appendFilled(size_t count, const T& item)
+		{
+			increaseCapacity(m_itemCount + count);
+			while (count)
+			{
+				size_t run{ std::min(count, chunkRemainder(m_itemCount)) };
+				T* destination{ &get(m_itemCount) };
+				if constexpr (std::is_trivially_copyable_v<T>)
+				{
+					std::memcpy(destination, &item, sizeof(T));
+					for (size_t filled{ 1 }; filled < run; filled *= 2)
+					{
+						std::memcpy(destination + filled, destination, std::min(filled, run - filled) * sizeof(T));
+					}
+				}
+				else
+				{
+					std::uninitialized_fill_n(destination, run, item);
+				}
+				m_itemCount += run;
+				count -= run;
+			}
+		}
+
+		template<typename Generator>
+		void appendGenerated(size_t count, Generator&& generator)
+		{
+			increaseCapacity(m_itemCount + count);
+			for (size_t index{}; index < count;)
+			{
+				size_t run{ std::min(count - index, chunkRemainder(m_itemCount)) };
+				T* destination{ &get(m_itemCount) };
+				for (size_t item{}; item < run; ++item)
+				{
+					std::allocator_traits<Allocator>::construct(m_allocator, destination + item, generator(index + item));
+				}
+				m_itemCount += run;
+				index += run;
+			}
+		}
+
+		void appendMoved(RigitArray& origin, size_t first, size_t count)
+		{
+			increaseCapacity(m_itemCount + count);
+			while (count)
+			{
+				size_t run{ std::min({ count, origin.contiguous(first), chunkRemainder(m_itemCount) }) };
+				T* source{ &origin.get(first) };
+				T* destination{ &get(m_itemCount) };
+				if constexpr (std::is_trivially_copyable_v<T>)
+				{
+					std::memcpy(destination, source, run * sizeof(T));
+				}
+				else
+				{
+					std::uninitialized_move_n(source, run, destination);
+				}
+				m_itemCount += run;
+				first += run;
+				count -= run;
+			}
+		}
+
+		void clear()
+		{
+			if constexpr (!std::is_trivially_destructible_v<T>)
+		{
+			for (size_t index{}; index < m_itemCount; ++index)
+			{
+				destroy(index);
+				}
+			}
+			decreaseCapacity(0);
+			m_itemCount = 0;
+		}
+
+		size_t size() const
+		{
+			return m_itemCount;
+		}
+
+		size_t capacity() const
+		{
+			return Layout::chunkStart(m_arrays.size());
+		}
+
+		void reserve(size_t capacity)
+		{
+			m_reserved = std::max(m_reserved, capacity);
+			increaseCapacity(capacity);
+		}
+
+		void shrinkToFit()
+		{
+			m_reserved = 0;
+			while (!m_arrays.empty() && Layout::chunkStart(m_arrays.size() - 1) >= m_itemCount)
+			{
+				releaseChunk();
+			}
+		}
+
+		bool empty() const
+		{
+			return !static_cast<bool>(m_itemCount);
+		}
+
+		const Allocator& getAllocator() const
+		{
+			return m_allocator;
+		}
+
+		RigitIterator<T> begin()
+		{
+			return RigitIterator<T>{m_arrays.data(), 0};
+		}
+
+		RigitIterator<T> end()
+		{
+			return RigitIterator<T>{nullptr, m_itemCount};
+		}
+
+		RigitArray copy() const
+		{
+			RigitArray<T, Allocator> out{ m_allocator };
+			out.append(*this, 0, m_itemCount);
+			return out;
+		}
+
+	private:
+		void constuct(size_t index, T&& item)
+		{
+			std::allocator_traits<Allocator>::construct(m_allocator, &get(index), std::move(item));
+		}
+
+		void destroy(size_t index)
+		{
+			std::allocator_traits<Allocator>::destroy(m_allocator, &get(index));
+		}
+
+		static size_t chunkRemainder(size_t index)
+		{
+			return Layout::chunkStart(Layout::chunkOf(index) + 1) - index;
+		}
+
+		void increaseCapacity(size_t newCapacity)
+		{
+			while (newCapacity > capacity())
+			{
+				m_arrays.push_back(std::allocator_traits<Allocator>::allocate(m_allocator, Layout::chunkSize(m_arrays.size())));
+			}
+		}
+
+		void decreaseCapacity(size_t newCapacity)
+		{
+			newCapacity = std::max(newCapacity, m_reserved);
+			if (newCapacity == 0)
+			{
+				while (!m_arrays.empty())
+				{
+					releaseChunk();
+				}
+				return;
+			}
+
+			while (m_arrays.size() > 1 && Layout::chunkStart(m_arrays.size() - 2) >= newCapacity)
+			{
+				releaseChunk();
+			}
+		}
+
+		void releaseChunk()
+			{
+				Array removal{ m_arrays.back() };
+			std::allocator_traits<Allocator>::deallocate(m_allocator, removal, Layout::chunkSize(m_arrays.size() - 1));
+				m_arrays.pop_back();
+		}
+	};
+
+
+	template<typename T>
+	class Indexer
+	{
+	private:
+		using EmptyIndexContainer = RigitArray<T>;
+
+		T m_nextIndex;
+		EmptyIndexContainer m_emptyIndices;
+
+	public:
+		Indexer(T start = 0, ObserverPtr<ChunkArena> arena = nullptr)
+			:m_nextIndex{start}, m_emptyIndices{ RigitAllocator<T>{ arena } }
+		{
+		}
+
+		T createIndex()
+		{
+			if (m_emptyIndices.empty())
+			{
+				return m_nextIndex++;
+			}
+
+			T out{ m_emptyIndices.back() };
+			m_emptyIndices.popBack();
+
+			return out;
+		}
+
+		T createIndices(size_t count)
+		{
+			T out{ m_nextIndex };
+			m_nextIndex += static_cast<T>(count);
+			return out;
+		}
+
+		void releaseIndex(T index)
+		{
+			m_emptyIndices.pushBack(index);
+		}
+
+		void releaseIndices(const RigitArray<T>& indices)
+		{
+			m_emptyIndices.append(indices, 0, indices.size());
+		}
+
+	};
+
+
+	class IComponentArray;
+	using ComponentArrayBase = std::unique_ptr<IComponentArray>;
+
+	class IComponentArray
+	{
+	public:
+		virtual ~IComponentArray() = default;
+
+		virtual void removeComponent() = 0;
+
+		virtual void swapComponents(Index left, Index right) = 0;
+
+		virtual void eraseSwapBack(Index index) = 0;
+
+		virtual void eraseSwapBack(const std::vector<size_t>& sortedIndices) = 0;
+
+		virtual void carryFrom(IComponentArray& origin, Index index) = 0;
+
+		virtual void copyFrom(const IComponentArray& origin, Index index) = 0;
+
+		virtual void carryFrom(IComponentArray& origin, Index first, size_t count) = 0;
+
+		virtual void copyFrom(const IComponentArray& origin, Index first, size_t count) = 0;
+
+		virtual void replicate(Index index, size_t count) = 0;
+
+		virtual void swapWith(IComponentArray& other) = 0;
+
+		virtual void clear() = 0;
+
+		virtual ComponentArrayBase copy() const = 0;
+
+	};
+
+	template<typename Component>
+	class ComponentArray : public IComponentArray
+	{
+	private:
+		RigitArray<Component> components;
+
+	public:
+		ComponentArray() = default;
+
+		ComponentArray(ObserverPtr<ChunkArena> arena) : components{ RigitAllocator<Component>{ arena } }
+		{
+		}
+
+		ComponentArray(const RigitArray<Component>& rigitArray) : components{ rigitArray }
+		{
+		}
+
+		ComponentArray(const ComponentArray& componentArray) = default;
+
+		ComponentArray(ComponentArray&& componentArray) = default;
+
+		ComponentArray& operator=(const ComponentArray& componentArray) = default;
+
+		ComponentArray& operator=(ComponentArray&& componentArray) = default;
+
+		~ComponentArray() = default;
+
+		void addComponent(const Component& component)
+		{
+			components.pushBack(component);
+		}
+
+		void addComponent(Component&& component)
+		{
+			components.pushBack(std::move(component));
+		}
+
+		void addComponents(size_t count, const Component& component)
+		{
+			components.appendFilled(count, component);
+		}
+
+		void removeComponent() override
+		{
+			components.popBack();
+		}
+
+		Component& getComponent(Index index)
+		{
+			return components.get(index);
+		}
+
+		const Component& getComponent(Index index) const
+		{
+			return components.get(index);
+		}
+
+		Component* data(Index index)
+		{
+			return &components.get(index);
+		}
+
+		size_t contiguous(Index index) const
+		{
+			return components.contiguous(index);
+		}
+
+		void setComponent(Index index, Component&& component)
+		{
+			components.set(index, std::move(component));
+		}
+
+		void swapComponents(Index left, Index right) override
+		{
+			components.swap(left, right);
+		}
+
+		void eraseSwapBack(Index index) override
+		{
+			components.eraseSwapBack(index);
+		}
+
+		void eraseSwapBack(const std::vector<size_t>& sortedIndices) override
+		{
+			components.eraseSwapBack(sortedIndices);
+		}
+
+		void carryFrom(IComponentArray& origin, Index index) override
+		{
+			addComponent(std::move(static_cast<ComponentArray<Component>&>(origin).getComponent(index)));
+		}
+
+		void copyFrom(const IComponentArray& origin, Index index) override
+		{
+			addComponent(static_cast<const ComponentArray<Component>&>(origin).getComponent(index));
+		}
+
+		void carryFrom(IComponentArray& origin, Index first, size_t count) override
+		{
+			components.appendMoved(static_cast<ComponentArray<Component>&>(origin).components, first, count);
+		}
+
+		void copyFrom(const IComponentArray& origin, Index first, size_t count) override
+		{
+			components.append(static_cast<const ComponentArray<Component>&>(origin).components, first, count);
+		}
+
+		void replicate(Index index, size_t count) override
+		{
+			components.appendFilled(count, components.get(index));
+		}
+
+		void swapWith(IComponentArray& other) override
+		{
+			std::swap(components, static_cast<ComponentArray<Component>&>(other).components);
+		}
+
+		void clear() override
+		{
+			components.clear();
+		}
+
+		ComponentArrayBase copy() const override
+		{
+			return std::make_unique<ComponentArray<Component>>(ComponentArray<Component>{components});
+		}
+
+		size_t size() const
+		{
+			return components.size();
+		}
+
+		bool empty() const
+		{
+			return static_cast<bool>(components.size());
+		}
+
+		RigitIterator<Component> begin()
+		{
+			return components.begin();
+		}
+
+		RigitIterator<Component> end()
+		{
+			return components.end();
+		}
+
+	};
+
+
+	constexpr uint64_t mixBits(uint64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccd;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53;
+		value ^= value >> 33;
+		return value;
+	}
+
+	template<typename T>
+	struct Hash
+	{
+		constexpr size_t operator()(const T& arg) const
+		{
+			size_t hash{ static_cast<size_t>(reinterpret_cast<std::uintptr_t>(&arg)) };
+			hash = ((hash >> 16) ^ hash) * 0x45d9f3b;
+			hash = ((hash >> 16) ^ hash) * 0x45d9f3b;
+			hash = ((hash >> 16) ^ hash);
+			return hash;
+		}
+	};
+
+	template<>
+	struct Hash<uint32_t>
+	{
+		constexpr uint32_t operator()(uint32_t arg) const
+		{
+			return arg;
+		}
+	};
+
+	template<>
+	struct Hash<uint16_t>
+	{
+		constexpr uint16_t operator()(uint16_t arg) const
+		{
+			return arg;
+		}
+	};
+
+	template<>
+	struct Hash<size_t>
+	{
+		constexpr size_t operator()(size_t arg) const
+		{
+			return arg;
+		}
+	};
+
+	template<>
+	struct Hash<std::string>
+	{
+		constexpr size_t operator()(const std::string& s) const
+		{
+			return operator()(s.c_str());
+		}
+
+		constexpr size_t operator()(const char* s) const
+		{
+			uint64_t hash{ 0xcbf29ce484222325 };
+
+			for (size_t index{}; s[index]; ++index)
+			{
+				hash ^= static_cast<unsigned char>(s[index]);
+				hash *= 0x100000001b3;
+			}
+
+			return static_cast<size_t>(hash);
+		}
+	};
+
+	template<>
+	struct Hash<Signature>
+	{
+		size_t operator()(const Signature& signature) const
+		{
+			uint64_t out{ 0x9e3779b97f4a7c15 };
+			for (Signature::Word word : signature.getWords())
+			{
+				out = mixBits(out ^ word);
+			}
+			return static_cast<size_t>(out);
+		}
+	};
+
+
+	class Cluster;
+
+	class Query
+	{
+	public:
+		using ClusterList = std::vector<ObserverPtr<Cluster>>;
+
+	private:
+		Signature m_required;
+		Signature m_excluded;
+		std::vector<ComponentID> m_components;
+		ClusterList m_clusters;
+		std::atomic<size_t> m_entities{};
+
+		friend class Cluster;
+		friend struct ClusterTraits;
+
+	public:
+		Query(const std::vector<ComponentID>& components, const Signature& excluded)
+			:m_excluded{ excluded }, m_components{ components }
+		{
+			for (ComponentID component : m_components)
+			{
+				m_required.set(component);
+			}
+		}
+
+		Query(const Query& query) = delete;
+
+		Query& operator=(const Query& query) = delete;
+
+		bool matches(const Signature& signature) const
+		{
+			return m_required.subset(signature) && !m_excluded.anyMatch(signature);
+		}
+
+		ClusterList& getClusters()
+		{
+			return m_clusters;
+		}
+
+		std::vector<ComponentID>& getComponents()
+		{
+			return m_components;
+		}
+
+		const Signature& getRequired() const
+		{
+			return m_required;
+		}
+
+		const Signature& getExcluded() const
+		{
+			return m_excluded;
+		}
+
+		size_t size() const
+		{
+			return m_entities;
+		}
+
+		bool empty() const
+		{
+			return m_entities == 0;
+		}
+	};
+
+
+	class Cluster;
+
+	struct ClusterEdge
+	{
+		using ColumnPair = std::pair<ObserverPtr<IComponentArray>, ObserverPtr<IComponentArray>>;
+
+		ObserverPtr<Cluster> destination;
+		std::vector<ColumnPair> columns;
+		ObserverPtr<IComponentArray> added;
+	};
+
+	class Cluster
+	{
+	private:
+		using ReverseMap = RigitArray<EntityID>;
+		using EdgeContainer = std::unordered_map<ComponentID, ClusterEdge, Hash<ComponentID>>;
+		using ColumnContainer = std::vector<ComponentArrayBase>;
+
+		ColumnContainer m_columns;
+		std::vector<ComponentID> m_components;
+		std::vector<Index> m_columnIndex;
+		ReverseMap m_reverse;
+		ClusterID m_id{ nullcluster };
+		ArchetypeID m_archetype{nullarchetype};
+		Signature m_signature;
+		EdgeContainer m_addEdges;
+		EdgeContainer m_removeEdges;
+		std::vector<ObserverPtr<Cluster>> m_incoming;
+		std::vector<ObserverPtr<Query>> m_queries;
+		SharedMutex m_mutex;
+
+		friend struct ClusterTraits;
+
+	public:
+		template<typename... Args>
+		struct Cache
+		{
+		private:
+			std::array<ObserverPtr<IComponentArray>, sizeof...(Args)> m_arrays;
+			ObserverPtr<RigitArray<EntityID>> m_ids;
+
+		public:
+			Cache() = default;
+
+			Cache(Cluster& cluster, const std::vector<ComponentID>& components)
+				:m_ids{ &cluster.m_reverse }
+			{
+				for (size_t index{}; index < m_arrays.size(); ++index)
+				{
+					m_arrays[index] = cluster.getColumn(components[index]);
+				}
+			}
+
+			std::tuple<EntityID, Args&...> getItems(Index index)
+			{
+				return getItems(index, std::index_sequence_for<Args...>{});
+			}
+
+			size_t contiguous(Index index)
+			{
+				return contiguous(index, std::index_sequence_for<Args...>{});
+			}
+
+			template<typename Function>
+			void invoke(Function& function, Index index, size_t count)
+			{
+				invoke(function, index, count, std::index_sequence_for<Args...>{});
+			}
+
+		private:
+			template <typename T>
+			ComponentArray<T>& get(ObserverPtr<IComponentArray>& base)
+			{
+				return *static_cast<ComponentArray<T>*>(base.get());
+			}
+
+			template<size_t... Indices>
+			std::tuple<EntityID, Args&...> getItems(Index index, std::index_sequence<Indices...>)
+			{
+				return std::tuple<EntityID, Args&...>(m_ids->get(index), get<Args>(m_arrays[Indices]).getComponent(index)...);
+			}
+
+			template<size_t... Indices>
+			size_t contiguous(Index index, std::index_sequence<Indices...>)
+			{
+				return std::min({ m_ids->contiguous(index), get<Args>(m_arrays[Indices]).contiguous(index)... });
+			}
+
+			template<typename Function, size_t... Indices>
+			void invoke(Function& function, Index index, size_t count, std::index_sequence<Indices...>)
+			{
+				function(static_cast<const EntityID*>(&m_ids->get(index)), get<Args>(m_arrays[Indices]).data(index)..., count);
+			}
+		};
+
+	public:
+		Cluster(ClusterID id, ArchetypeID archetype, const Signature& signature, ObserverPtr<ChunkArena> arena = nullptr)
+			:m_reverse{ RigitAllocator<EntityID>{ arena } }, m_id{ id }, m_archetype{ archetype }, m_signature{signature}
+		{
+		}
+
+		Cluster(const Cluster& cluster)
+			:m_components{ cluster.m_components }, m_columnIndex{ cluster.m_columnIndex }, 
+			m_reverse{ cluster.m_reverse }, m_archetype{ cluster.m_archetype }, m_signature{cluster.m_signature}
+		{
+			for (const ComponentArrayBase& column : cluster.m_columns)
+			{
+				m_columns.push_back(column->copy());
+			}
+		}
+
+		Cluster& operator=(const Cluster& cluster)
+		{
+			m_reverse = cluster.m_reverse;
+			m_archetype = cluster.m_archetype;
+			m_signature = cluster.m_signature;
+			m_components = cluster.m_components;
+			m_columnIndex = cluster.m_columnIndex;
+
+			m_columns.clear();
+			for (const ComponentArrayBase& column : cluster.m_columns)
+			{
+				m_columns.push_back(column->copy());
+			}
+			return *this;
+		}
+
+		Cluster& operator=(Cluster&& cluster) noexcept
+		{
+			m_columns = std::move(cluster.m_columns);
+			m_components = std::move(cluster.m_components);
+			m_columnIndex = std::move(cluster.m_columnIndex);
+			m_reverse = std::move(cluster.m_reverse);
+			m_archetype = cluster.m_archetype;
+			m_signature = std::move(cluster.m_signature);
+			m_id = cluster.m_id;
+			cluster.m_id = nullcluster;
+			return *this;
+		}
+
+		~Cluster() = default;
+
+		ClusterID getID() const
+		{
+			return m_id;
+		}
+
+		void setID(ClusterID id)
+		{
+			m_id = id;
+		}
+
+		ArchetypeID getArchetype() const
+		{
+			return m_archetype;
+		}
+
+		const Signature& getSignature() const
+		{
+			return m_signature;
+		}
+
+		void setSignature(const Signature& signature)
+		{
+			m_signature = signature;
+		}
+
+		ObserverPtr<ClusterEdge> getEdge(ComponentID component, bool add)
+		{
+			EdgeContainer& edges{ add ? m_addEdges : m_removeEdges };
+			auto found{ edges.find(component) };
+			if (found == edges.end())
+			{
+				return nullptr;
+			}
+			return &found->second;
+		}
+
+		Index addEntity(EntityID id)
+		{
+			Index row{ static_cast<Index>(m_reverse.size()) };
+			m_reverse.pushBack(id);
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				++query->m_entities;
+			}
+			return row;
+		}
+
+		Index addEntities(EntityID first, size_t count)
+		{
+			Index row{ static_cast<Index>(m_reverse.size()) };
+			m_reverse.appendGenerated(count, [first](size_t index) { return first + static_cast<EntityID>(index); });
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				query->m_entities += count;
+			}
+			return row;
+		}
+
+		void replicate(Index row, size_t count)
+		{
+			for (ComponentArrayBase& column : m_columns)
+			{
+				column->replicate(row, count);
+			}
+		}
+
+		EntityID getEntity(Index row) const
+		{
+			return m_reverse.get(row);
+		}
+
+		const RigitArray<EntityID>& getEntities() const
+		{
+			return m_reverse;
+		}
+
+		template<typename T>
+		T& getComponent(Index row, ComponentID component)
+		{
+			return getArray<T>(component).getComponent(row);
+		}
+
+		template<typename T>
+		const T& getComponent(Index row, ComponentID component) const
+		{
+			return getArray<T>(component).getComponent(row);
+		}
+
+		template<typename... Args>
+		std::tuple<EntityID, Args&...> getComponents(Index row, const std::vector<ComponentID>& components)
+		{
+			return Cache<Args...>{ *this, components }.getItems(row);
+		}
+
+		template<typename T>
+		void addComponent(const T& item, EntityID id, ComponentID component)
+		{
+			addComponent<T>(T{ item }, id, component);
+		}
+
+		template<typename T>
+		void addComponent(T&& item, EntityID, ComponentID component)
+		{
+			getArray<T>(component).addComponent(std::move(item));
+		}
+
+		template<typename T>
+		void fillComponent(const T& item, size_t count, ComponentID component)
+		{
+			getArray<T>(component).addComponents(count, item);
+		}
+
+		template<typename... Args>
+		void addComponents(Args&&... item, EntityID, const std::vector<ComponentID>& components)
+		{
+			Index index{ 0 };
+			((getArray<Args>(components[index]).addComponent(std::move(item)), ++index), ...);
+		}
+
+		EntityID removeEntity(Index row)
+		{
+			for (ComponentArrayBase& column : m_columns)
+			{
+				column->eraseSwapBack(row);
+			}
+
+			m_reverse.eraseSwapBack(row);
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				--query->m_entities;
+			}
+			if (row < m_reverse.size())
+			{
+				return m_reverse.get(row);
+			}
+			return nullent;
+		}
+
+		void removeEntities(const std::vector<size_t>& rows)
+		{
+			for (ComponentArrayBase& column : m_columns)
+			{
+				column->eraseSwapBack(rows);
+			}
+			m_reverse.eraseSwapBack(rows);
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				query->m_entities -= rows.size();
+			}
+		}
+
+		void clear()
+		{
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				query->m_entities -= m_reverse.size();
+			}
+			for (ComponentArrayBase& column : m_columns)
+			{
+				column->clear();
+			}
+			m_reverse.clear();
+		}
+
+		template<typename T>
+		void setComponent(const T& item, Index row, ComponentID component)
+		{
+			setComponent<T>(T{ item }, row, component);
+		}
+
+		template<typename T>
+		void setComponent(T&& item, Index row, ComponentID component)
+		{
+			getArray<T>(component).setComponent(row, std::move(item));
+		}
+
+		void addArray(ComponentID component, ComponentArrayBase&& rigitArray)
+		{
+			if (hasArray(component))
+			{
+				m_columns[m_columnIndex[component]] = std::move(rigitArray);
+				return;
+		}
+
+			auto position{ std::lower_bound(m_components.begin(), m_components.end(), component) };
+			Index column{ static_cast<Index>(position - m_components.begin()) };
+			m_components.insert(position, component);
+			m_columns.insert(m_columns.begin() + column, std::move(rigitArray));
+			if (m_columnIndex.size() <= component)
+		{
+				m_columnIndex.resize(component + 1, nullcolumn);
+			}
+			reindex(column);
+		}
+
+		void removeArray(ComponentID component)
+		{
+			if (!hasArray(component))
+			{
+				return;
+			}
+
+			Index column{ m_columnIndex[component] };
+			m_components.erase(m_components.begin() + column);
+			m_columns.erase(m_columns.begin() + column);
+			m_columnIndex[component] = nullcolumn;
+			reindex(column);
+		}
+
+		ObserverPtr<IComponentArray> getColumn(ComponentID component)
+		{
+			if (!hasArray(component))
+			{
+				return nullptr;
+			}
+			return m_columns[m_columnIndex[component]].get();
+		}
+
+		const std::vector<ComponentID>& getComponents() const
+		{
+			return m_components;
+		}
+
+		size_t size() const
+		{
+			return m_reverse.size();
+		}
+
+		bool empty() const
+		{
+			return m_reverse.empty();
+		}
+
+		bool linked() const
+		{
+			return !m_incoming.empty();
+		}
+
+		SharedMutex& getMutex()
+		{
+			return m_mutex;
+		}
+
+		bool hasArray(ComponentID component) const
+		{
+			return component < m_columnIndex.size() && m_columnIndex[component] != nullcolumn;
+		}
+
+	protected:
+		template<typename T>
+		ComponentArray<T>& getArray(ComponentID component)
+		{
+			return *static_cast<ComponentArray<T>*>(m_columns[m_columnIndex[component]].get());
+		}
+
+		template<typename T>
+		const ComponentArray<T>& getArray(ComponentID component) const
+		{
+			return *static_cast<const ComponentArray<T>*>(m_columns[m_columnIndex[component]].get());
+		}
+
+		void reindex(Index first)
+		{
+			for (Index column{ first }; column < m_components.size(); ++column)
+			{
+				m_columnIndex[m_components[column]] = column;
+			}
+		}
+	};
+
+
+	struct EntityLocation
+	{
+		ObserverPtr<Cluster> cluster;
+		Index row{};
+	};
+
+	class EntityContainer
+	{
+	private:
+		using EntityLocationMap = RigitArray<EntityLocation>;
+		using GenerationMap = RigitArray<Generation>;
+
+		EntityLocationMap m_entites;
+		GenerationMap m_generations;
+
+	public:
+		EntityContainer(ObserverPtr<ChunkArena> arena = nullptr)
+			:m_entites{ RigitAllocator<EntityLocation>{ arena } }, m_generations{ RigitAllocator<Generation>{ arena } }
+		{
+			m_entites.pushBack(EntityLocation{});
+			m_generations.pushBack(0);
+		}
+
+		~EntityContainer() = default;
+
+		static Index getIndex(EntityID id)
+		{
+			return static_cast<Index>(id);
+		}
+
+		static Generation getGeneration(EntityID id)
+			{
+			return static_cast<Generation>(id >> GENERATION_SHIFT);
+		}
+
+		static EntityID createID(Index index, Generation generation)
+		{
+			return (EntityID{ generation } << GENERATION_SHIFT) | index;
+		}
+
+		EntityID addEntity(EntityID id, ObserverPtr<Cluster> cluster= nullptr, Index row = 0)
+		{
+			Index index{ getIndex(id) };
+			if (index < m_entites.size())
+			{
+				m_entites[index] = EntityLocation{ cluster, row };
+			}
+			else 
+			{
+				m_entites.pushBack(EntityLocation{ cluster, row });
+				m_generations.pushBack(0);
+			}
+			return createID(index, m_generations[index]);
+		}
+
+		void addEntities(EntityID first, size_t count, ObserverPtr<Cluster> cluster, Index row)
+		{
+			assert(getIndex(first) == m_entites.size());
+			m_entites.appendGenerated(count, [cluster, row](size_t index)
+				{
+					return EntityLocation{ cluster, row + static_cast<Index>(index) };
+				});
+			m_generations.appendFilled(count, 0);
+		}
+
+		void removeEntity(EntityID id)
+		{
+			Index index{ getIndex(id) };
+			setCluster(id, nullptr, 0);
+			std::atomic_ref<Generation> generation{ m_generations[index] };
+			generation.store((generation.load(std::memory_order_relaxed) + 1) & GENERATION_MASK, std::memory_order_release);
+		}
+
+		bool isAlive(EntityID id) const
+		{
+			Index index{ getIndex(id) };
+			return id != nullent && index < m_generations.size() &&
+				std::atomic_ref<Generation>{ const_cast<Generation&>(m_generations[index]) }.load(std::memory_order_acquire) == getGeneration(id);
+		}
+
+		EntityLocation& getLocation(EntityID id)
+		{
+			return m_entites[getIndex(id)];
+		}
+
+		ObserverPtr<Cluster>& getEntityCluster(EntityID id)
+		{
+			return m_entites[getIndex(id)].cluster;
+		}
+
+		ObserverPtr<Cluster> loadCluster(EntityID id)
+		{
+			return std::atomic_ref<ObserverPtr<Cluster>>{ m_entites[getIndex(id)].cluster }.load(std::memory_order_acquire);
+		}
+
+		const Signature& getSignature(EntityID id)
+		{
+			return m_entites[getIndex(id)].cluster->getSignature();
+		}
+
+		ClusterID getClusterID(EntityID id)
+		{
+			return m_entites[getIndex(id)].cluster->getID();
+		}
+
+		void setCluster(EntityID id, ObserverPtr<Cluster> cluster, Index row)
+		{
+			EntityLocation& location{ m_entites[getIndex(id)] };
+			location.row = row;
+			std::atomic_ref<ObserverPtr<Cluster>>{ location.cluster }.store(cluster, std::memory_order_release);
+		}
+	};
+
+
+	struct ClusterTraits
+	{
+		static void carryEntity(EntityID id, EntityContainer& entities, Cluster& destination)
+		{
+			EntityLocation& location{ entities.getLocation(id) };
+			Cluster& current{ *location.cluster };
+			Index oldRow{ location.row };
+			Index row{ destination.addEntity(id) };
+			eachSharedColumn(current, destination, [oldRow](IComponentArray& origin, IComponentArray& target)
+			{
+					target.carryFrom(origin, oldRow);
+				});
+			removeRow(current, oldRow, entities);
+			location = EntityLocation{ &destination, row };
+		}
+
+		static void carryEntity(EntityID id, EntityContainer& entities, ClusterEdge& edge)
+		{
+			EntityLocation& location{ entities.getLocation(id) };
+			Index oldRow{ location.row };
+			Index row{ edge.destination->addEntity(id) };
+			for (ClusterEdge::ColumnPair& columns : edge.columns)
+			{
+				columns.second->carryFrom(*columns.first, oldRow);
+			}
+			removeRow(*location.cluster, oldRow, entities);
+			entities.setCluster(id, edge.destination, row);
+		}
+
+		static Index carryEntities(Cluster& current, Cluster& destination, EntityContainer& entities)
+		{
+			Index first{ static_cast<Index>(destination.size()) };
+			size_t count{ current.size() };
+			if (destination.empty())
+			{
+				eachSharedColumn(current, destination, [](IComponentArray& origin, IComponentArray& target)
+					{
+						target.swapWith(origin);
+					});
+				std::swap(current.m_reverse, destination.m_reverse);
+			}
+			else
+			{
+				eachSharedColumn(current, destination, [count](IComponentArray& origin, IComponentArray& target)
+					{
+						target.carryFrom(origin, 0, count);
+					});
+				destination.m_reverse.append(current.m_reverse, 0, count);
+			}
+
+			for (ObserverPtr<Query>& query : current.m_queries)
+			{
+				query->m_entities -= count;
+			}
+			for (ObserverPtr<Query>& query : destination.m_queries)
+			{
+				query->m_entities += count;
+			}
+			for (ComponentArrayBase& column : current.m_columns)
+			{
+				column->clear();
+			}
+			current.m_reverse.clear();
+
+			for (Index row{ first }; row < destination.size(); ++row)
+			{
+				entities.getLocation(destination.m_reverse.get(row)) = EntityLocation{ &destination, row };
+			}
+			return first;
+		}
+
+		static void removeEntity(EntityID id, EntityContainer& entities)
+		{
+			releaseEntity(id, entities);
+			entities.removeEntity(id);
+		}
+
+		static void releaseEntity(EntityID id, EntityContainer& entities)
+		{
+			EntityLocation& location{ entities.getLocation(id) };
+			removeRow(*location.cluster, location.row, entities);
+			entities.setCluster(id, nullptr, 0);
+		}
+
+		static void removeEntities(Cluster& cluster, std::vector<size_t>& rows, EntityContainer& entities)
+		{
+			std::sort(rows.begin(), rows.end());
+			rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+			cluster.removeEntities(rows);
+			for (size_t row : rows)
+			{
+				if (row < cluster.size())
+				{
+					entities.getLocation(cluster.getEntity(static_cast<Index>(row))).row = static_cast<Index>(row);
+				}
+			}
+		}
+
+		static ClusterEdge bridge(Cluster& current, Cluster& destination)
+		{
+			ClusterEdge edge{ &destination, {}, {} };
+			eachSharedColumn(current, destination, [&edge](IComponentArray& origin, IComponentArray& target)
+				{
+						edge.columns.emplace_back(&origin, &target);
+					});
+			return edge;
+		}
+
+		static ClusterEdge& link(Cluster& current, ComponentID component, bool add, ObserverPtr<Cluster> destination)
+		{
+			ClusterEdge edge;
+			if (destination.isValid())
+			{
+				edge = bridge(current, *destination);
+				if (add)
+				{
+					edge.added = destination->getColumn(component);
+				}
+				destination->m_incoming.push_back(&current);
+			}
+
+			Cluster::EdgeContainer& edges{ add ? current.m_addEdges : current.m_removeEdges };
+			return edges[component] = std::move(edge);
+		}
+
+		static void unlink(Cluster& cluster)
+		{
+			auto pointsTo{ [&cluster](const auto& pair) { return pair.second.destination.get() == &cluster; } };
+			for (ObserverPtr<Cluster>& source : cluster.m_incoming)
+			{
+				std::erase_if(source->m_addEdges, pointsTo);
+				std::erase_if(source->m_removeEdges, pointsTo);
+			}
+			cluster.m_incoming.clear();
+
+			for (Cluster::EdgeContainer* edges : { &cluster.m_addEdges, &cluster.m_removeEdges })
+			{
+				for (auto& pair : *edges)
+				{
+					ObserverPtr<Cluster> destination{ pair.second.destination };
+					if (destination.isValid())
+					{
+						auto& incoming{ destination->m_incoming };
+						incoming.erase(std::find_if(incoming.begin(), incoming.end(),
+							[&cluster](ObserverPtr<Cluster>& source) { return source.get() == &cluster; }));
+					}
+				}
+				edges->clear();
+			}
+		}
+
+		static void attach(Query& query, Cluster& cluster)
+		{
+			query.m_clusters.push_back(&cluster);
+			query.m_entities += cluster.size();
+			cluster.m_queries.push_back(&query);
+		}
+
+		static void detach(Query& query, Cluster& cluster)
+		{
+			auto& clusters{ query.m_clusters };
+			clusters.erase(std::find_if(clusters.begin(), clusters.end(),
+				[&cluster](ObserverPtr<Cluster>& item) { return item.get() == &cluster; }));
+			query.m_entities -= cluster.size();
+
+			auto& queries{ cluster.m_queries };
+			queries.erase(std::find_if(queries.begin(), queries.end(),
+				[&query](ObserverPtr<Query>& item) { return item.get() == &query; }));
+		}
+
+		static void detach(Cluster& cluster)
+		{
+			while (!cluster.m_queries.empty())
+			{
+				detach(*cluster.m_queries.back(), cluster);
+			}
+		}
+
+		static void detach(Query& query)
+		{
+			while (!query.m_clusters.empty())
+			{
+				detach(query, *query.m_clusters.back());
+			}
+		}
+
+		static void copyEntity(EntityID newEntity, EntityID oldEntity, Cluster& current, Cluster& destination, EntityContainer& entities)
+		{
+			Index oldRow{ entities.getLocation(oldEntity).row };
+			Index row{ destination.addEntity(newEntity) };
+			eachSharedColumn(current, destination, [oldRow](IComponentArray& origin, IComponentArray& target)
+			{
+					target.copyFrom(origin, oldRow);
+				});
+			entities.setCluster(newEntity, &destination, row);
+		}
+
+	private:
+		static void removeRow(Cluster& cluster, Index row, EntityContainer& entities)
+		{
+			EntityID moved{ cluster.removeEntity(row) };
+			if (moved != nullent)
+			{
+				entities.getLocation(moved).row = row;
+			}
+		}
+
+		template<typename Function>
+		static void eachSharedColumn(Cluster& current, Cluster& destination, Function&& function)
+				{
+			size_t left{};
+			size_t right{};
+			while (left < current.m_components.size() && right < destination.m_components.size())
+			{
+				if (current.m_components[left] < destination.m_components[right])
+				{
+					++left;
+				}
+				else if (destination.m_components[right] < current.m_components[left])
+				{
+					++right;
+				}
+				else
+				{
+					function(*current.m_columns[left++], *destination.m_columns[right++]);
+				}
+			}
+		}
+	};
+
+
+	class IRecipie
+	{
+	public:
+		virtual ComponentArrayBase createArray(ObserverPtr<ChunkArena> arena) const = 0;
+	};
+
+	template<typename T>
+	class Recipie : public IRecipie
+	{
+	public:
+		ComponentArrayBase createArray(ObserverPtr<ChunkArena> arena) const override
+		{
+			return std::make_unique<ComponentArray<T>>(arena);
+		}
+	};
+
+	using RecipieBase = std::unique_ptr<IRecipie>;
+
+	class ComponentRegister
+	{
+	private:
+		using RecipieContainer = std::unordered_map<ComponentID, RecipieBase>;
+		using IDConverter = std::unordered_map<TypeName, ComponentID>;
+
+		Indexer<ComponentID> m_indexer{};
+		RecipieContainer m_recipies;
+		IDConverter m_componentIDS;
+		std::vector<TypeName> m_typeNames;
+		std::vector<ComponentID> m_types;
+
+	public:
+		ComponentRegister() = default;
+
+		template<typename T>
+		ComponentID registerComponent()
+		{
+			TypeID type{ TypeIndex::get<T>() };
+			if (type < m_types.size() && m_types[type] != nullcomponent)
+			{
+				return m_types[type];
+			}
+
+			ComponentID id{ registerComponent<T>(typeid(T).name()) };
+			if (m_types.size() <= type)
+			{
+				m_types.resize(type + 1, nullcomponent);
+			}
+			m_types[type] = id;
+			return id;
+		}
+
+		template<typename T>
+		ComponentID registerComponent(const TypeName& name)
+		{
+			auto found{ m_componentIDS.find(name) };
+			if (found != m_componentIDS.end())
+			{
+				return found->second;
+			}
+
+			if (m_typeNames.size() >= MAX_COMPONENTS)
+			{
+				throw std::length_error{ "component count exceeds MAX_COMPONENTS" };
+			}
+
+				Index id{ m_indexer.createIndex() };
+				m_componentIDS[name] = id;
+				m_typeNames.push_back(name);
+				m_recipies[id] = std::make_unique<Recipie<T>>();
+			return id;
+			}
+
+		template<typename T>
+		bool registered() const
+		{
+			TypeID type{ TypeIndex::get<T>() };
+			return type < m_types.size() && m_types[type] != nullcomponent;
+		}
+
+		bool registered(const TypeName& name) const
+		{
+			return m_componentIDS.contains(name);
+		}
+
+		template<typename T>
+		ComponentID getID() const
+		{
+			TypeID type{ TypeIndex::get<T>() };
+			return type < m_types.size() ? m_types[type] : nullcomponent;
+		}
+
+		ComponentID getID(const TypeName& name) const
+		{
+			return m_componentIDS.at(name);
+		}
+
+		TypeName getName(ComponentID id) const
+		{
+			return m_typeNames[id];
+		}
+
+		ObserverPtr<IRecipie> getRecipie(ComponentID id) const
+		{
+			return m_recipies.at(id).get();
+		}
+	};
+
+
+	class ClusterGroup
+	{
+	public:
+		using Group = std::set<ClusterID>;
+
+	private:
+		Group m_group;
+
+	public:
+		ClusterGroup() = default;
+
+		void add(ClusterID id)
+		{
+			m_group.insert(id);
+		}
+
+		void remove(ClusterID id)
+		{
+			m_group.erase(id);
+		}
+
+		bool empty() const
+		{
+			return m_group.empty();
+		}
+
+		ClusterID getDefault() const
+		{
+			return *m_group.begin();
+		}
+
+		const Group& getGroup() const
+		{
+			return m_group;
+		}
+	};
+
+	class ArchetypeTable
+	{
+	private:
+		using IDContainer = std::unordered_map<Signature, ArchetypeID, Hash<Signature>>;
+		using ArchetypeList = std::vector<ArchetypeID>;
+
+		std::vector<Signature> m_signatures;
+		IDContainer m_ids;
+		std::vector<ArchetypeList> m_withComponent;
+
+	public:
+		ArchetypeTable() = default;
+
+		ArchetypeID intern(const Signature& signature)
+		{
+			auto found{ m_ids.find(signature) };
+			if (found != m_ids.end())
+			{
+				return found->second;
+			}
+
+			ArchetypeID id{ static_cast<ArchetypeID>(m_signatures.size()) };
+			m_signatures.push_back(signature);
+			m_ids.emplace(signature, id);
+			for (ComponentID component : signature.getComponents())
+			{
+				if (m_withComponent.size() <= component)
+				{
+					m_withComponent.resize(component + 1);
+				}
+				m_withComponent[component].push_back(id);
+			}
+			return id;
+		}
+
+		ArchetypeID find(const Signature& signature) const
+		{
+			auto found{ m_ids.find(signature) };
+			if (found == m_ids.end())
+			{
+				return nullarchetype;
+			}
+			return found->second;
+		}
+
+		const Signature& getSignature(ArchetypeID id) const
+		{
+			return m_signatures[id];
+		}
+
+		const ArchetypeList& getArchetypes(ComponentID component) const
+		{
+			static const ArchetypeList empty;
+			if (component < m_withComponent.size())
+			{
+				return m_withComponent[component];
+			}
+			return empty;
+		}
+
+		ObserverPtr<const ArchetypeList> rarest(const Signature& signature) const
+		{
+			ObserverPtr<const ArchetypeList> out;
+			for (ComponentID component : signature.getComponents())
+			{
+				const ArchetypeList& archetypes{ getArchetypes(component) };
+				if (!out.isValid() || archetypes.size() < out->size())
+				{
+					out = &archetypes;
+				}
+			}
+			return out;
+		}
+
+		size_t size() const
+		{
+			return m_signatures.size();
+		}
+	};
+
+	class ClusterContainer
+	{
+	public:
+		using ClusterWindow = std::vector<ObserverPtr<Cluster>>;
+
+	private:
+		using Container = std::unordered_map<ComponentID, std::unique_ptr<Cluster>, Hash<ComponentID>>;
+		using GroupContainer = std::vector<ClusterGroup>;
+		using QueryContainer = std::vector<std::unique_ptr<Query>>;
+
+		Container m_clusters;
+		ArchetypeTable m_archetypes;
+		GroupContainer m_groups;
+		QueryContainer m_queries;
+		Indexer<ClusterID> m_indexer{ 1 };
+		ObserverPtr<ChunkArena> m_arena;
+
+	public:
+		ClusterContainer(ObserverPtr<ChunkArena> arena = nullptr)
+			:m_arena{ arena }
+		{
+		}
+
+		~ClusterContainer() = default;
+
+		ObserverPtr<Cluster> createCluster(const Signature& signature, const ComponentRegister& components)
+		{
+			ClusterID id{ m_indexer.createIndex() };
+			ArchetypeID archetype{ m_archetypes.intern(signature) };
+			std::unique_ptr<Cluster> cluster{ std::make_unique<Cluster>(id, archetype, signature, m_arena) };
+			for (ComponentID component : signature.getComponents())
+			{
+				cluster->addArray(component, createArray(components.getRecipie(component)));
+			}
+			ObserverPtr<Cluster> out{ cluster.get() };
+			m_clusters[id] = std::move(cluster);
+
+			if (m_groups.size() <= archetype)
+			{
+				m_groups.resize(archetype + 1);
+			}
+
+			m_groups[archetype].add(id);
+
+			for (std::unique_ptr<Query>& query : m_queries)
+			{
+				if (query->matches(signature))
+				{
+					ClusterTraits::attach(*query, *out);
+				}
+			}
+
+			return out;
+		}
+
+		void removeCluster(Cluster& cluster)
+		{
+			ClusterTraits::unlink(cluster);
+			ClusterTraits::detach(cluster);
+
+			ClusterID id{ cluster.getID() };
+			m_groups[cluster.getArchetype()].remove(id);
+			m_clusters.erase(id);
+			m_indexer.releaseIndex(id);
+		}
+
+		void removeEmptyClusters()
+		{
+			std::vector<ObserverPtr<Cluster>> removals;
+			for (auto& pair : m_clusters)
+			{
+				if (pair.second->empty())
+				{
+					removals.push_back(pair.second.get());
+				}
+			}
+			for (ObserverPtr<Cluster>& cluster : removals)
+			{
+				removeCluster(*cluster);
+			}
+		}
+
+		ObserverPtr<Cluster> getCluster(ClusterID id)
+		{
+			return m_clusters[id].get();
+		}
+
+		ObserverPtr<Cluster> getCluster(const Signature& signature, const ComponentRegister& components)
+		{
+			ArchetypeID archetype{ m_archetypes.find(signature) };
+			if (archetype == nullarchetype || m_groups[archetype].empty())
+			{
+				return createCluster(signature, components);
+			}
+
+			return m_clusters[m_groups[archetype].getDefault()].get();
+		}
+
+		ClusterEdge& getEdge(Cluster& cluster, ComponentID component, bool add, const ComponentRegister& components)
+		{
+			ObserverPtr<ClusterEdge> edge{ cluster.getEdge(component, add) };
+			if (edge.isValid())
+			{
+				return *edge;
+			}
+
+			Signature signature{ cluster.getSignature() };
+			signature.set(component, add);
+			ObserverPtr<Cluster> destination;
+			if (signature.any())
+			{
+				destination = getCluster(signature, components);
+			}
+			return ClusterTraits::link(cluster, component, add, destination);
+		}
+
+		ClusterWindow getClusters(const Signature& subset, const Signature& noIntersection)
+		{
+			ClusterWindow out;
+			ObserverPtr<const std::vector<ArchetypeID>> candidates{ m_archetypes.rarest(subset) };
+			if (!candidates.isValid())
+			{
+			for (ArchetypeID archetype{}; archetype < m_groups.size(); ++archetype)
+			{
+					collect(archetype, subset, noIntersection, out);
+				}
+				return out;
+			}
+
+			for (ArchetypeID archetype : *candidates)
+				{
+				collect(archetype, subset, noIntersection, out);
+			}
+			return out;
+		}
+
+		bool has(ClusterID id) const
+		{
+			return m_clusters.contains(id);
+		}
+
+		ObserverPtr<Query> createQuery(const std::vector<ComponentID>& components, const Signature& excluded)
+		{
+			std::unique_ptr<Query> query{ std::make_unique<Query>(components, excluded) };
+			for (ObserverPtr<Cluster>& cluster : getClusters(query->getRequired(), excluded))
+			{
+				ClusterTraits::attach(*query, *cluster);
+			}
+			ObserverPtr<Query> out{ query.get() };
+			m_queries.push_back(std::move(query));
+			return out;
+		}
+
+		void destroyQuery(ObserverPtr<Query> query)
+		{
+			ClusterTraits::detach(*query);
+			m_queries.erase(std::find_if(m_queries.begin(), m_queries.end(),
+				[&query](std::unique_ptr<Query>& item) { return item.get() == query.get(); }));
+		}
+
+		const ArchetypeTable& getArchetypes() const
+		{
+			return m_archetypes;
+		}
+
+	private:
+		ComponentArrayBase createArray(ObserverPtr<IRecipie> recipie) const
+		{
+			return recipie->createArray(m_arena);
+		}
+
+		void collect(ArchetypeID archetype, const Signature& subset, const Signature& noIntersection, ClusterWindow& out)
+		{
+			const Signature& check{ m_archetypes.getSignature(archetype) };
+			if (!m_groups[archetype].empty() && subset.subset(check) && !noIntersection.anyMatch(check))
+			{
+				for (ClusterID id : m_groups[archetype].getGroup())
+				{
+					out.push_back(getCluster(id));
+				}
+			}
+		}
+	};
+
+
+	// Concurrency: m_structure guards the cluster graph, the register and the entity table,
+	// and each cluster's mutex guards its rows. Lookups, getComponent, setComponent and
+	// readComponent hold both shared, so concurrent reads and in-place writes of distinct
+	// components are safe. Moving or destroying a single entity holds m_structure shared and
+	// only the source and destination clusters exclusively; anything that creates entities,
+	// clusters, edges or registrations, or touches whole clusters, takes m_structure exclusively.
+	// References from getComponent and views stay valid only until that cluster changes structure.
+	// Structure locks nest per thread and pool, but a shared hold cannot be upgraded to an exclusive one.
+	// A thread may hold the locks of up to MAX_LOCKED_POOLS pools at once.
+	class Pool
+	{
+	private:
+		ChunkArena m_arena;
+		ComponentRegister m_register;
+		ClusterContainer m_clusters{ m_arena };
+		EntityContainer m_entites{ m_arena };
+		Indexer<EntityID> m_indexer{ 1, m_arena };
+		mutable SharedMutex m_structure;
+		SharedMutex m_released;
+
+		struct LockState
+		{
+			const Pool* pool;
+			bool exclusive;
+		};
+
+		static constexpr size_t MAX_LOCKED_POOLS{ 8 };
+
+		static inline thread_local std::array<LockState, MAX_LOCKED_POOLS> t_locked{};
+		static inline thread_local size_t t_lockedCount{};
+
+		friend class Accessor;
+		friend class CommandBuffer;
+
+	public:
+		class StructureLock
+		{
+		private:
+			const Pool* m_pool;
+			bool m_exclusive{};
+			bool m_owner{};
+
+		public:
+			StructureLock(const Pool& pool, bool exclusive)
+				:m_pool{ &pool }, m_exclusive{ exclusive }
+			{
+				for (size_t index{}; index < t_lockedCount; ++index)
+				{
+					if (t_locked[index].pool == &pool)
+					{
+						if (m_exclusive && !t_locked[index].exclusive)
+					{
+						throw std::logic_error{ "structure lock cannot be upgraded from shared to exclusive" };
+					}
+					return;
+					}
+				}
+				if (t_lockedCount == MAX_LOCKED_POOLS)
+				{
+					throw std::length_error{ "too many pools are structure locked by one thread" };
+				}
+				if (m_exclusive)
+				{
+					pool.m_structure.lock();
+				}
+				else
+				{
+					pool.m_structure.lock_shared();
+				}
+				t_locked[t_lockedCount++] = LockState{ &pool, m_exclusive };
+				m_owner = true;
+			}
+
+			StructureLock(const StructureLock& lock) = delete;
+
+			StructureLock& operator=(const StructureLock& lock) = delete;
+
+			~StructureLock()
+			{
+				if (!m_owner)
+				{
+					return;
+				}
+				for (size_t index{}; index < t_lockedCount; ++index)
+				{
+					if (t_locked[index].pool == m_pool)
+					{
+						t_locked[index] = t_locked[--t_lockedCount];
+						break;
+					}
+				}
+				if (m_exclusive)
+				{
+					m_pool->m_structure.unlock();
+				}
+				else
+				{
+					m_pool->m_structure.unlock_shared();
+				}
+			}
+		};
+
+		Pool() = default;
+
+		~Pool() = default;
+
+		EntityID createEntity()
+		{
+			StructureLock lock{ *this, true };
+			return m_entites.addEntity(m_indexer.createIndex());
+		}
+
+		bool isAlive(EntityID id) const
+		{
+			StructureLock lock{ *this, false };
+			return m_entites.isAlive(id);
+		}
+
+		template<typename... Args>
+		EntityRange spawn(size_t count, const Args&... components)
+		{
+			StructureLock lock{ *this, true };
+			if (count == 0)
+			{
+				return EntityRange{};
+			}
+
+			EntityRange out{ m_indexer.createIndices(count), count };
+			if constexpr (sizeof...(Args) == 0)
+			{
+				m_entites.addEntities(out.front(), count, nullptr, 0);
+				return out;
+			}
+
+			Cluster& cluster{ *m_clusters.getCluster(createSignature<Args...>(), m_register) };
+			Index row{ cluster.addEntities(out.front(), count) };
+			m_entites.addEntities(out.front(), count, &cluster, row);
+			(cluster.fillComponent<Args>(components, count, m_register.getID<Args>()), ...);
+			return out;
+		}
+
+		template<typename... Args, typename Generator>
+			requires std::invocable<Generator&, EntityID, Args&...>
+		EntityRange spawn(size_t count, Generator&& generator)
+		{
+			StructureLock lock{ *this, true };
+			EntityRange out{ spawn<Args...>(count, Args{}...) };
+			if (out.empty())
+			{
+				return out;
+			}
+			if constexpr (sizeof...(Args) == 0)
+			{
+				for (EntityID id : out)
+				{
+					generator(id);
+				}
+				return out;
+			}
+
+			EntityLocation& location{ m_entites.getLocation(out.front()) };
+			Cluster::Cache<Args...> cache{ *location.cluster, registerComponents<Args...>() };
+			auto fill{ [&generator](const EntityID* ids, Args*... components, size_t size)
+				{
+					for (size_t index{}; index < size; ++index)
+					{
+						generator(ids[index], components[index]...);
+					}
+				} };
+			for (Index row{ location.row }; row < location.row + count;)
+			{
+				size_t run{ std::min<size_t>(cache.contiguous(row), location.row + count - row) };
+				cache.invoke(fill, row, run);
+				row += static_cast<Index>(run);
+			}
+			return out;
+		}
+
+		void destroyEntity(EntityID id)
+		{
+			if (releaseEntity(id))
+			{
+				return;
+			}
+
+			StructureLock lock{ *this, true };
+			if (!isAlive(id))
+			{
+				return;
+			}
+			ObserverPtr<Cluster> cluster{ m_entites.getEntityCluster(id) };
+			m_indexer.releaseIndex(id);
+
+			if (!cluster.isValid())
+			{
+				m_entites.removeEntity(id);
+				return;
+			}
+			ClusterTraits::removeEntity(id, m_entites);
+				checkCluster(*cluster);
+		}
+
+		void destroyEntities(const std::vector<EntityID>& ids)
+		{
+			StructureLock lock{ *this, true };
+			std::vector<EntityID> unique{ ids };
+			std::sort(unique.begin(), unique.end());
+			unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+			std::unordered_map<ClusterID, std::vector<size_t>, Hash<ClusterID>> removals;
+			for (EntityID id : unique)
+			{
+				if (!isAlive(id))
+				{
+					continue;
+				}
+				EntityLocation location{ m_entites.getLocation(id) };
+				m_entites.removeEntity(id);
+				m_indexer.releaseIndex(id);
+
+				if (location.cluster.isValid())
+				{
+					removals[location.cluster->getID()].push_back(location.row);
+				}
+			}
+
+			for (auto& pair : removals)
+			{
+				ObserverPtr<Cluster> cluster{ m_clusters.getCluster(pair.first) };
+				ClusterTraits::removeEntities(*cluster, pair.second, m_entites);
+				checkCluster(*cluster);
+			}
+		}
+
+		void destroyEntities(ObserverPtr<Query> query)
+		{
+			StructureLock lock{ *this, true };
+			std::vector<ObserverPtr<Cluster>> clusters{ query->getClusters() };
+			for (ObserverPtr<Cluster>& cluster : clusters)
+			{
+				dropCluster(*cluster);
+			}
+		}
+
+		template<typename T>
+		void addComponent(EntityID id, T&& component)
+		{
+			addComponent<T>(id, std::move(component), acquireComponent<T>());
+		}
+
+		template<typename T>
+		void addComponent(EntityID id, T&& component, const TypeName& name)
+		{
+			ComponentID componentID{};
+			{
+				StructureLock lock{ *this, true };
+				componentID = m_register.registerComponent<T>(name);
+			}
+			addComponent<T>(id, std::move(component), componentID);
+		}
+
+		template<typename T>
+		void addComponent(EntityID id, T&& component, ComponentID componentID)
+		{
+			auto add{ [&component](ClusterEdge& edge)
+				{
+					static_cast<ComponentArray<T>&>(*edge.added).addComponent(std::move(component));
+				} };
+			if (moveEntity(id, componentID, true, add))
+			{
+				return;
+			}
+
+			StructureLock lock{ *this, true };
+			if (!isAlive(id))
+			{
+				return;
+			}
+			EntityLocation& location{ m_entites.getLocation(id) };
+			if (!location.cluster.isValid())
+			{
+				Signature signature;
+				signature.set(componentID);
+				ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
+				location = EntityLocation{ newCluster, newCluster->addEntity(id) };
+				newCluster->addComponent(std::move(component), id, componentID);
+				return;
+			}
+
+			if (location.cluster->getSignature().check(componentID))
+			{
+				location.cluster->setComponent<T>(std::move(component), location.row, componentID);
+				return;
+			}
+
+			Cluster& current{ *location.cluster };
+			ClusterEdge& edge{ m_clusters.getEdge(current, componentID, true, m_register) };
+			ClusterTraits::carryEntity(id, m_entites, edge);
+			static_cast<ComponentArray<T>&>(*edge.added).addComponent(std::move(component));
+			checkCluster(current);
+		}
+
+		template<typename T>
+		void addComponent(ObserverPtr<Query> query, const T& component)
+		{
+			StructureLock lock{ *this, true };
+			ComponentID componentID{ m_register.registerComponent<T>() };
+			std::vector<ObserverPtr<Cluster>> clusters{ query->getClusters() };
+			for (ObserverPtr<Cluster>& cluster : clusters)
+			{
+				if (cluster->getSignature().check(componentID))
+				{
+					for (Index row{}; row < cluster->size(); ++row)
+					{
+						cluster->setComponent<T>(component, row, componentID);
+					}
+					continue;
+				}
+
+				Cluster& destination{ *m_clusters.getEdge(*cluster, componentID, true, m_register).destination };
+				size_t count{ cluster->size() };
+				ClusterTraits::carryEntities(*cluster, destination, m_entites);
+				destination.fillComponent<T>(component, count, componentID);
+				checkCluster(*cluster);
+			}
+		}
+
+		template<typename T>
+		void removeComponent(EntityID id)
+		{
+			ComponentID componentID{ findComponent<T>() };
+			if (componentID != nullcomponent)
+			{
+				removeComponent(id, componentID);
+			}
+		}
+
+		void removeComponent(EntityID id, const TypeName& name)
+		{
+			ComponentID componentID{ findComponent(name) };
+			if (componentID != nullcomponent)
+			{
+				removeComponent(id, componentID);
+			}
+			}
+
+		void removeComponent(EntityID id, ComponentID componentID)
+		{
+			if (moveEntity(id, componentID, false, [](ClusterEdge&) {}))
+			{
+				return;
+			}
+
+			StructureLock lock{ *this, true };
+			if (!isAlive(id))
+			{
+				return;
+			}
+			ObserverPtr<Cluster> oldCluster{ m_entites.getEntityCluster(id) };
+			if (!oldCluster.isValid() || !oldCluster->getSignature().check(componentID))
+			{
+				return;
+			}
+
+			Cluster& current{ *oldCluster };
+			ClusterEdge& edge{ m_clusters.getEdge(current, componentID, false, m_register) };
+			if (!edge.destination.isValid())
+			{
+				destroyEntity(id);
+				return;
+			}
+
+			ClusterTraits::carryEntity(id, m_entites, edge);
+			checkCluster(current);
+		}
+
+		template<typename T>
+		void removeComponent(ObserverPtr<Query> query)
+		{
+			ComponentID componentID{ findComponent<T>() };
+			if (componentID != nullcomponent)
+			{
+				removeComponent(query, componentID);
+			}
+		}
+
+		void removeComponent(ObserverPtr<Query> query, ComponentID componentID)
+		{
+			StructureLock lock{ *this, true };
+			std::vector<ObserverPtr<Cluster>> clusters{ query->getClusters() };
+			for (ObserverPtr<Cluster>& cluster : clusters)
+			{
+				if (!cluster->getSignature().check(componentID))
+				{
+					continue;
+				}
+
+				ClusterEdge& edge{ m_clusters.getEdge(*cluster, componentID, false, m_register) };
+				if (!edge.destination.isValid())
+				{
+					dropCluster(*cluster);
+					continue;
+				}
+				ClusterTraits::carryEntities(*cluster, *edge.destination, m_entites);
+				checkCluster(*cluster);
+			}
+		}
+
+		template<typename T>
+		T& getComponent(EntityID id)
+		{
+			StructureLock lock{ *this, false };
+			return getComponent<T>(id, m_register.getID<T>());
+		}
+
+		template<typename T>
+		T& getComponent(EntityID id, const TypeName& name)
+		{
+			StructureLock lock{ *this, false };
+			return getComponent<T>(id, m_register.getID(name));
+		}
+
+		template<typename T>
+		T& getComponent(EntityID id, ComponentID component)
+		{
+			T* out{};
+			if (!visitEntity(id, [&out, component](Cluster& cluster, Index row)
+				{
+					out = &cluster.getComponent<T>(row, component);
+				}))
+			{
+				throw std::out_of_range{ "entity is not alive or has no components" };
+			}
+			return *out;
+		}
+
+		template<typename T>
+		T readComponent(EntityID id)
+		{
+			StructureLock lock{ *this, false };
+			return readComponent<T>(id, m_register.getID<T>());
+		}
+
+		template<typename T>
+		T readComponent(EntityID id, ComponentID component)
+		{
+			std::optional<T> out;
+			if (!visitEntity(id, [&out, component](Cluster& cluster, Index row)
+				{
+					out.emplace(cluster.getComponent<T>(row, component));
+				}))
+			{
+				throw std::out_of_range{ "entity is not alive or has no components" };
+			}
+			return std::move(*out);
+		}
+
+		template<typename T>
+		void setComponent(EntityID id, T&& component)
+		{
+			StructureLock lock{ *this, false };
+			setComponent<T>(id, std::move(component), m_register.getID<T>());
+		}
+
+		template<typename T>
+		void setComponent(EntityID id, T&& component, const TypeName& name)
+		{
+			StructureLock lock{ *this, false };
+			setComponent<T>(id, std::move(component), m_register.getID(name));
+		}
+
+		template<typename T>
+		void setComponent(EntityID id, T&& item, ComponentID component)
+		{
+			visitEntity(id, [&item, component](Cluster& cluster, Index row)
+				{
+					cluster.setComponent<T>(std::move(item), row, component);
+				});
+		}
+
+		template<typename... Args>
+		void addComponents(EntityID id, Args&&... components, const std::vector<TypeName>& names)
+		{
+			StructureLock lock{ *this, true };
+			std::vector<ComponentID> componentIDs;
+			Index index{ 0 };
+			((componentIDs.push_back(m_register.registerComponent<Args>(names[index])), ++index), ...);
+			addComponents<Args...>(id, std::move(components)..., componentIDs);
+		}
+
+		template<typename... Args>
+		void addComponents(EntityID id, Args&&... components, const std::vector<ComponentID>& componentIDs)
+		{
+			StructureLock lock{ *this, true };
+			if (!isAlive(id))
+			{
+				return;
+			}
+			Signature addition;
+			for (ComponentID componentID : componentIDs)
+			{
+				addition.set(componentID);
+			}
+			ObserverPtr<Cluster> oldCluster{ m_entites.getEntityCluster(id) };
+
+			Signature signature;
+			if (oldCluster.isValid())
+			{
+				signature = oldCluster->getSignature();
+			}
+			signature += addition;
+
+			ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
+			if (oldCluster.isValid())
+			{
+				ClusterTraits::carryEntity(id, m_entites, *newCluster);
+				checkCluster(*oldCluster);
+			}
+			else
+			{
+				m_entites.setCluster(id, newCluster, newCluster->addEntity(id));
+			}
+			newCluster->addComponents<Args...>(std::move(components)..., id, componentIDs);
 		}
 
-		const Signature& getSignature() const
-		{
-			return m_signature;
-		}
+		template <typename... Args>
+		std::vector<ComponentID> registerComponents()
+			{
+			StructureLock lock{ *this, true };
+			return { m_register.registerComponent<Args>()... };
+			}
 
-		void setSignature(const Signature& signature)
+		template <typename... Args>
+		Signature createSignature()
 		{
-			m_signature = signature;
+			StructureLock lock{ *this, true };
+			Signature out;
+			(out.set(m_register.registerComponent<Args>()), ...);
+			return out;
 		}
 
-		void addEntity(EntityID id)
+		template <typename... Args>
+		Signature createSignature(const std::vector<TypeName>& names)
 		{
-			Index index{ static_cast<Index>(m_indices.size()) };
-			m_indices[id] = index;
-			m_reverse.pushBack(id);
+			StructureLock lock{ *this, true };
+			Signature out;
+			Index index{ 0 };
+			((out.set(m_register.registerComponent<Args>(names[index])), ++index), ...);
+			return out;
 		}
 
-		template<typename T>
-		T& getComponent(EntityID id, const TypeName& typeName)
+		Cluster& getCluster(EntityID id)
 		{
-			return getArray<T>(typeName).getComponent(m_indices[id]);
+			StructureLock lock{ *this, false };
+			return *m_entites.loadCluster(id);
 		}
 
-		template<typename T>
-		const T& getComponent(EntityID id, const TypeName& typeName) const
+		void copyEntity(EntityID newEntity, EntityID oldEntity)
 		{
-			return getArray<T>(typeName).getComponent(m_indices[id]);
+			StructureLock lock{ *this, true };
+			if (newEntity == oldEntity || !isAlive(newEntity) || !isAlive(oldEntity))
+			{
+				return;
+			}
+			ObserverPtr<Cluster> currentCluster{ m_entites.getEntityCluster(newEntity) };
+			ObserverPtr<Cluster> originCluster{ m_entites.getEntityCluster(oldEntity) };
+
+			if (currentCluster.isValid())
+			{
+				ClusterTraits::releaseEntity(newEntity, m_entites);
+			}
+			if (originCluster.isValid())
+			{
+				ClusterTraits::copyEntity(newEntity, oldEntity, *originCluster, *originCluster, m_entites);
+			}
+			if (currentCluster.isValid() && currentCluster != originCluster)
+			{
+				checkCluster(*currentCluster);
+			}
 		}
 
-		template<typename... Args>
-		std::tuple<EntityID, Args&...> getComponents(EntityID id, const std::vector<TypeName>& typeNames)
+		EntityRange instantiate(EntityID prefab, size_t count)
 		{
-			return getDirect<Args...>(m_indices[id], typeNames);
+			StructureLock lock{ *this, true };
+			if (count == 0 || !isAlive(prefab))
+			{
+				return EntityRange{};
+			}
+
+			EntityRange out{ m_indexer.createIndices(count), count };
+			EntityLocation location{ m_entites.getLocation(prefab) };
+			if (!location.cluster.isValid())
+			{
+				m_entites.addEntities(out.front(), count, nullptr, 0);
+				return out;
+			}
+
+			Index row{ location.cluster->addEntities(out.front(), count) };
+			m_entites.addEntities(out.front(), count, location.cluster, row);
+			location.cluster->replicate(location.row, count);
+			return out;
 		}
 
-		template<typename T>
-		void addComponent(const T& item, EntityID id, const TypeName& typeName)
+		void carryEntity(EntityID id, ClusterID newCluster)
 		{
-			addComponent<T>(T{ item }, id, typeName);
+			StructureLock lock{ *this, true };
+			ObserverPtr<Cluster> oldCluster{ m_entites.getEntityCluster(id) };
+			ObserverPtr<Cluster> destination{ m_clusters.getCluster(newCluster) };
+			ClusterTraits::carryEntity(id, m_entites, *destination);
+			checkCluster(*oldCluster);
 		}
 
 		template<typename T>
-		void addComponent(T&& item, EntityID id, const TypeName& typeName)
+		bool hasComponent(EntityID id)
 		{
-			getArray<T>(typeName).addComponent(std::move(item));
+			StructureLock lock{ *this, false };
+			return hasComponent(id, m_register.getID<T>());
 		}
 
-		template<typename... Args>
-		void addComponents(Args&&... item, EntityID id, const std::vector<TypeName>& typeNames)
+		bool hasComponent(EntityID id, const TypeName& name)
 		{
-			Index index{ 0 };
-			((getArray<Args>(typeNames[index]).addComponent(std::move(item)), ++index), ...);
+			StructureLock lock{ *this, false };
+			return m_register.registered(name) && hasComponent(id, m_register.getID(name));
 		}
 
-		void removeEntity(EntityID id)
+		bool hasComponent(EntityID id, ComponentID component)
 		{
-			Index lastIndex{ static_cast<Index>(m_reverse.size() - 1) };
-			for (auto& keyArrayPair : m_arrays)
+			StructureLock lock{ *this, false };
+			if (!isAlive(id))
 			{
-				Index index{ m_indices[id] };
-				keyArrayPair.second->swapComponents(index, lastIndex);
-				keyArrayPair.second->removeComponent();
+				return false;
 			}
-
-			EntityID swapKey{ m_reverse[lastIndex] };
-			m_indices[swapKey] = m_indices[id];
-			m_reverse[m_indices[id]] = swapKey;
-			m_reverse.popBack();
-			m_indices.erase(id);
+			ObserverPtr<Cluster> cluster{ m_entites.loadCluster(id) };
+			return cluster.isValid() && cluster->getSignature().check(component);
 		}
 
-		template<typename T>
-		void setComponent(const T& item, EntityID id, const TypeName& typeName)
+		void removeEmptyClusters()
 		{
-			set<T>(T{ item }, id, typeName);
+			StructureLock lock{ *this, true };
+			m_clusters.removeEmptyClusters();
 		}
 
-		template<typename T>
-		void setComponent(T&& item, EntityID id, const TypeName& typeName)
+		template<typename... Args>
+		ObserverPtr<Query> createQuery(const Signature& excluded = Signature{})
 		{
-			getArray<T>(typeName).setComponent(std::move(item), m_indices[id]);
+			StructureLock lock{ *this, true };
+			return m_clusters.createQuery(registerComponents<Args...>(), excluded);
 		}
 
-		void addArray(const TypeName& typeName, ComponentArrayBase&& rigitArray)
+		ObserverPtr<Query> createQuery(const std::vector<ComponentID>& components, const Signature& excluded = Signature{})
 		{
-			m_arrays[typeName] = std::move(rigitArray);
+			StructureLock lock{ *this, true };
+			return m_clusters.createQuery(components, excluded);
 		}
 
-		void removeArray(const TypeName& typeName)
+		void destroyQuery(ObserverPtr<Query> query)
 		{
-			m_arrays.erase(typeName);
+			StructureLock lock{ *this, true };
+			m_clusters.destroyQuery(query);
 		}
 
-		size_t size() const
+		ChunkArena& getArena()
 		{
-			return m_reverse.size();
+			return m_arena;
 		}
 
-		bool empty() const
+		ArenaStatistics getArenaStatistics() const
 		{
-			return m_reverse.empty();
+			return m_arena.getStatistics();
 		}
 
-		bool hasEntity(EntityID id) const
+	private:
+		template<typename T>
+		ComponentID findComponent() const
 		{
-			return m_indices.contains(id);
+			StructureLock lock{ *this, false };
+			return m_register.getID<T>();
 		}
 
-		bool hasArray(const TypeName& typeName) const
+		ComponentID findComponent(const TypeName& name) const
 		{
-			return m_arrays.contains(typeName);
+			StructureLock lock{ *this, false };
+			return m_register.registered(name) ? m_register.getID(name) : nullcomponent;
 		}
 
-	protected:
 		template<typename T>
-		ComponentArray<T>& getArray(const TypeName& arrayIndex)
+		ComponentID acquireComponent()
 		{
-			return *static_cast<ComponentArray<T>*>(m_arrays[arrayIndex].get());
+			ComponentID out{ findComponent<T>() };
+			if (out != nullcomponent)
+			{
+				return out;
+			}
+			StructureLock lock{ *this, true };
+			return m_register.registerComponent<T>();
 		}
-	};
 
+		template<typename Function>
+		bool visitEntity(EntityID id, Function&& function)
+		{
+			StructureLock lock{ *this, false };
+			while (m_entites.isAlive(id))
+			{
+				ObserverPtr<Cluster> cluster{ m_entites.loadCluster(id) };
+				if (!cluster.isValid())
+				{
+					return false;
+				}
 
-	struct ClusterTraits
-	{
-		static void carryEntity(EntityID newEntity, EntityID oldEntity, Cluster& current, Cluster& destination)
+				std::shared_lock<SharedMutex> rows{ cluster->getMutex() };
+				if (m_entites.loadCluster(id) == cluster)
+				{
+					function(*cluster, m_entites.getLocation(id).row);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		template<typename Function>
+		bool moveEntity(EntityID id, ComponentID component, bool add, Function&& function)
 		{
-			ArrayContainer& currentArrays{ current.m_arrays };
-			Index oldIndex{ current.m_indices[oldEntity] };
-			destination.addEntity(newEntity);
-			for (auto& pair : destination.m_arrays)
+			StructureLock lock{ *this, false };
+			while (m_entites.isAlive(id))
 			{
-				auto found{ currentArrays.find(pair.first) };
-				if (found != currentArrays.end())
+				ObserverPtr<Cluster> current{ m_entites.loadCluster(id) };
+				if (!current.isValid() || current->getSignature().check(component) == add)
+				{
+					return false;
+				}
+				ObserverPtr<ClusterEdge> edge{ current->getEdge(component, add) };
+				if (!edge.isValid() || !edge->destination.isValid())
+				{
+					return false;
+				}
+
+				std::scoped_lock<SharedMutex, SharedMutex> rows{ current->getMutex(), edge->destination->getMutex() };
+				if (m_entites.loadCluster(id) != current)
+				{
+					continue;
+				}
+				if (current->size() == 1 && !current->linked())
 				{
-					pair.second->carryFrom(*found->second, oldIndex);
+					return false;
 				}
+				ClusterTraits::carryEntity(id, m_entites, *edge);
+				function(*edge);
+				return true;
 			}
-			current.removeEntity(oldEntity);
+			return true;
 		}
 
-		static void copyEntity(EntityID newEntity, EntityID oldEntity, Cluster& current, Cluster& destination)
+		bool releaseEntity(EntityID id)
 		{
-			ArrayContainer& currentArrays{ current.m_arrays };
-			Index oldIndex{ current.m_indices[oldEntity] };
-			destination.addEntity(newEntity);
-			for (auto& pair : destination.m_arrays)
+			StructureLock lock{ *this, false };
+			while (m_entites.isAlive(id))
 			{
-				auto found{ currentArrays.find(pair.first) };
-				if (found != currentArrays.end())
+				ObserverPtr<Cluster> cluster{ m_entites.loadCluster(id) };
+				if (!cluster.isValid())
+				{
+					return false;
+				}
+
+				std::unique_lock<SharedMutex> rows{ cluster->getMutex() };
+				if (m_entites.loadCluster(id) != cluster)
+				{
+					continue;
+				}
+				if (cluster->size() == 1 && !cluster->linked())
 				{
-					pair.second->copyFrom(*found->second, oldIndex);
+					return false;
 				}
+				ClusterTraits::removeEntity(id, m_entites);
+				std::lock_guard<SharedMutex> released{ m_released };
+				m_indexer.releaseIndex(id);
+				return true;
 			}
+			return true;
+		}
+
+		void dropCluster(Cluster& cluster)
+		{
+			for (Index row{}; row < cluster.size(); ++row)
+			{
+				m_entites.removeEntity(cluster.getEntity(row));
+			}
+			m_indexer.releaseIndices(cluster.getEntities());
+			cluster.clear();
+			checkCluster(cluster);
 		}
 
+		void checkCluster(Cluster& cluster)
+		{
+			if (cluster.empty() && !cluster.linked())
+			{
+				m_clusters.removeCluster(cluster);
+			}
+		}
 	};
 
 
-	class IRecipie
+	class ICommandColumn
 	{
 	public:
-		virtual ComponentArrayBase createArray() const = 0;
+		virtual ~ICommandColumn() = default;
+
+		virtual ComponentID registerComponent(ComponentRegister& components) = 0;
+
+		virtual void addTo(IComponentArray& array, Index value) = 0;
+
+		virtual void setIn(IComponentArray& array, Index row, Index value) = 0;
+
+		virtual Index append(ICommandColumn& column) = 0;
+
+		virtual std::unique_ptr<ICommandColumn> create() const = 0;
+
+		virtual void clear() = 0;
 	};
 
 	template<typename T>
-	class Recipie : public IRecipie
+	class CommandColumn: public ICommandColumn
 	{
+	private:
+		std::vector<T> m_values;
+
 	public:
-		ComponentArrayBase createArray() const override
+		CommandColumn() = default;
+
+		Index push(T&& value)
 		{
-			return std::make_unique<ComponentArray<T>>();
+			m_values.push_back(std::move(value));
+			return static_cast<Index>(m_values.size() - 1);
 		}
-	};
-
-	using RecipieBase = std::unique_ptr<IRecipie>;
-
-	class ComponentRegister
-	{
-	private:
-		using RecipieContainer = std::unordered_map<ComponentID, RecipieBase>;
-		using IDConverter = std::unordered_map<TypeName, ComponentID>;
 
-		Indexer<ComponentID> m_indexer{};
-		RecipieContainer m_recipies;
-		IDConverter m_componentIDS;
-		std::vector<TypeName> m_typeNames;
-
-	public:
-		ComponentRegister() = default;
+		ComponentID registerComponent(ComponentRegister& components) override
+		{
+			return components.registerComponent<T>();
+		}
 
-		template<typename T>
-		void registerComponent(const TypeName& name)
+		void addTo(IComponentArray& array, Index value) override
 		{
-			if (!registered(name))
-			{
-				Index id{ m_indexer.createIndex() };
-				m_componentIDS[name] = id;
-				m_typeNames.push_back(name);
-				m_recipies[id] = std::make_unique<Recipie<T>>();
-			}
+			static_cast<ComponentArray<T>&>(array).addComponent(std::move(m_values[value]));
 		}
 
-		bool registered(const TypeName& name) const
+		void setIn(IComponentArray& array, Index row, Index value) override
 		{
-			return m_componentIDS.contains(name);
+			static_cast<ComponentArray<T>&>(array).setComponent(row, std::move(m_values[value]));
 		}
 
-		ComponentID getID(const TypeName& name) const
+		Index append(ICommandColumn& column) override
 		{
-			return m_componentIDS.at(name);
+			std::vector<T>& values{ static_cast<CommandColumn<T>&>(column).m_values };
+			Index out{ static_cast<Index>(m_values.size()) };
+			if (m_values.empty())
+			{
+				m_values.swap(values);
+			}
+			else
+			{
+				m_values.insert(m_values.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+			}
+			values.clear();
+			return out;
 		}
 
-		TypeName getName(ComponentID id) const
+		std::unique_ptr<ICommandColumn> create() const override
 		{
-			return m_typeNames[id];
+			return std::make_unique<CommandColumn<T>>();
 		}
 
-		ObserverPtr<IRecipie> getRecipie(ComponentID id) const
+		void clear() override
 		{
-			return m_recipies.at(id).get();
+			m_values.clear();
 		}
 	};
 
+	using CommandColumnBase = std::unique_ptr<ICommandColumn>;
 
-	class ClusterGroup
+	class CommandBuffer
 	{
 	public:
-		using Group = std::set<ClusterID>;
+		static constexpr EntityID PROVISIONAL_BIT{ EntityID{ GENERATION_MASK + 1 } << GENERATION_SHIFT };
 
 	private:
-		Group m_group;
-
-	public:
-		ClusterGroup() = default;
-
-		void add(ClusterID id)
-		{
-			m_group.insert(id);
-		}
-
-		void remove(ClusterID id)
+		enum class CommandType : uint8_t
 		{
-			m_group.erase(id);
-		}
+			Destroy,
+			Add,
+			Remove,
+			Set
+		};
 
-		bool empty() const
+		struct Command
 		{
-			return m_group.empty();
-		}
+			EntityID entity;
+			CommandType type;
+			TypeID column;
+			Index value;
+		};
 
-		ClusterID getDefault() const
+		struct Pending
 		{
-			return *m_group.begin();
-		}
+			ComponentID component;
+			TypeID column;
+			Index value;
+			bool existing;
+		};
 
-		const Group& getGroup() const
+		struct Move
 		{
-			return m_group;
-		}
-	};
-
-	class ClusterContainer
-	{
-	public:
-		using ClusterWindow = std::vector<ObserverPtr<Cluster>>;
-
-	private:
-		using Container = std::unordered_map<ComponentID, std::unique_ptr<Cluster>, Hash<ComponentID>>;
-		using GroupContainer = std::unordered_map<Signature, ClusterGroup, Hash<Signature>>;
+			EntityID entity;
+			Index first;
+			Index count;
+			Signature signature;
+		};
 
-		Container m_clusters;
-		GroupContainer m_groups;
-		Indexer<ClusterID> m_indexer{ 1 };
+		std::vector<Command> m_commands;
+		std::vector<CommandColumnBase> m_columns;
+		std::vector<EntityID> m_resolved;
+		std::vector<EntityID> m_destroyed;
+		std::vector<Move> m_moves;
+		std::vector<Pending> m_pending;
+		EntityID m_created{};
 
 	public:
-		ClusterContainer() = default;
-
-		~ClusterContainer() = default;
+		CommandBuffer() = default;
 
-		ObserverPtr<Cluster> createCluster(const Signature& signature, const ComponentRegister& components)
-		{
-			ClusterID id{ m_indexer.createIndex() };
-			std::unique_ptr<Cluster> cluster{ std::make_unique<Cluster>(id,signature) };
-			for (ComponentID id : signature.getComponents())
-			{
-				cluster->addArray(components.getName(id), createArray(components.getRecipie(id)));
-			}
-			ObserverPtr<Cluster> out{ cluster.get() };
-			m_clusters[id] = std::move(cluster);
+		CommandBuffer(const CommandBuffer& buffer) = delete;
 
-			if (!m_groups.contains(signature))
-			{
-				createGroup(signature);
-			}
+		CommandBuffer(CommandBuffer&& buffer) noexcept = default;
 
-			m_groups[signature].add(id);
+		CommandBuffer& operator=(const CommandBuffer& buffer) = delete;
 
-			return out;
-		}
+		CommandBuffer& operator=(CommandBuffer&& buffer) noexcept = default;
 
-		void removeCluster(Cluster& cluster)
-		{
-			ClusterID id{ cluster.getID() };
-			ClusterGroup& group{ m_groups[cluster.getSignature()] };
-			group.remove(id);
-			if (group.empty())
-			{
-				m_groups.erase(cluster.getSignature());
-			}
-			m_clusters.erase(id);
-			m_indexer.releaseIndex(id);
-		}
+		~CommandBuffer() = default;
 
-		ObserverPtr<Cluster> getCluster(ClusterID id)
+		EntityID createEntity()
 		{
-			return m_clusters[id].get();
+			return PROVISIONAL_BIT | m_created++;
 		}
 
-		ObserverPtr<Cluster> getCluster(const Signature& signature, const ComponentRegister& components)
+		void destroyEntity(EntityID id)
 		{
-			auto result{ m_groups.find(signature) };
-			if (result == m_groups.end())
-			{
-				return createCluster(signature, components);
-			}
-
-			return m_clusters[result->second.getDefault()].get();
+			m_commands.push_back(Command{ id, CommandType::Destroy, TypeID{}, Index{} });
 		}
 
-		ClusterWindow getClusters(const Signature& subset, const Signature& noIntersection)
+		template<typename T>
+		void addComponent(EntityID id, const T& component)
 		{
-			ClusterWindow out;
-			for (auto& pair : m_groups)
-			{
-				const Signature& check{ pair.first };
-
-				if (subset.subset(check) && !noIntersection.anyMatch(check))
-				{
-					for (ClusterID id : pair.second.getGroup())
-					{
-						out.push_back(getCluster(id));
-					}
-				}
-			}
-			return out;
+			addComponent<T>(id, T{ component });
 		}
 
-		bool has(ClusterID id) const
+		template<typename T>
+		void addComponent(EntityID id, T&& component)
 		{
-			return m_clusters.contains(id);
+			TypeID type{ TypeIndex::get<T>() };
+			m_commands.push_back(Command{ id, CommandType::Add, type, getColumn<T>(type).push(std::move(component)) });
 		}
 
-	private:
-		ComponentArrayBase createArray(ObserverPtr<IRecipie> recipie) const
+		template<typename T>
+		void removeComponent(EntityID id)
 		{
-			return recipie->createArray();
+			TypeID type{ TypeIndex::get<T>() };
+			getColumn<T>(type);
+			m_commands.push_back(Command{ id, CommandType::Remove, type, Index{} });
 		}
 
-		void createGroup(const Signature& signature)
+		template<typename T>
+		void setComponent(EntityID id, const T& component)
 		{
-			m_groups[signature] = ClusterGroup{};
+			setComponent<T>(id, T{ component });
 		}
-	};
 
-
-	class EntityContainer
-	{
-	private:
-		using EntityClusterMap = RigitArray<ObserverPtr<Cluster>>;
-
-		EntityClusterMap m_entites;
-
-	public:
-		EntityContainer()
+		template<typename T>
+		void setComponent(EntityID id, T&& component)
 		{
-			m_entites.pushBack(nullptr);
+			TypeID type{ TypeIndex::get<T>() };
+			m_commands.push_back(Command{ id, CommandType::Set, type, getColumn<T>(type).push(std::move(component)) });
 		}
 
-		~EntityContainer() = default;
+		static bool isProvisional(EntityID id)
+		{
+			return (id & PROVISIONAL_BIT) != 0;
+		}
 
-		void addEntity(EntityID id, ObserverPtr<Cluster> cluster = nullptr)
+		EntityID resolve(EntityID id) const
 		{
-			if (id < m_entites.size())
+			if (!isProvisional(id))
 			{
-				m_entites[id] = cluster;
+				return id;
 			}
-			else
+			EntityID index{ id & ~PROVISIONAL_BIT };
+			if (index >= m_resolved.size())
 			{
-				m_entites.pushBack(cluster);
+				throw std::out_of_range{ "provisional entity has not been played back by this buffer" };
 			}
+			return m_resolved[index];
 		}
 
-		void removeEntity(EntityID id)
+		EntityID getCreated() const
 		{
-			m_entites[id] = nullptr;
+			return m_created;
 		}
 
-		ObserverPtr<Cluster>& getEntityCluster(EntityID id)
+		bool empty() const
 		{
-			return m_entites[id];
+			return m_commands.empty() && m_created == 0;
 		}
 
-		const Signature& getSignature(EntityID id)
+		void clear()
 		{
-			return m_entites[id]->getSignature();
+			m_commands.clear();
+			for (CommandColumnBase& column : m_columns)
+			{
+				if (column)
+				{
+					column->clear();
+				}
+			}
+			m_destroyed.clear();
+			m_moves.clear();
+			m_pending.clear();
+			m_created = 0;
 		}
 
-		ClusterID getClusterID(EntityID id)
+		EntityID merge(CommandBuffer& buffer)
 		{
-			return m_entites[id]->getID();
-		}
+			EntityID out{ m_created };
+			if (m_columns.size() < buffer.m_columns.size())
+			{
+				m_columns.resize(buffer.m_columns.size());
+			}
+			std::vector<Index> offsets(buffer.m_columns.size());
+			for (TypeID type{}; type < buffer.m_columns.size(); ++type)
+			{
+				if (!buffer.m_columns[type])
+				{
+					continue;
+				}
+				if (!m_columns[type])
+				{
+					m_columns[type] = buffer.m_columns[type]->create();
+				}
+				offsets[type] = m_columns[type]->append(*buffer.m_columns[type]);
+			}
 
-		void setCluster(EntityID id, ObserverPtr<Cluster> cluster)
-		{
-			m_entites[id] = cluster;
+			m_commands.reserve(m_commands.size() + buffer.m_commands.size());
+			for (Command command : buffer.m_commands)
+			{
+				if (isProvisional(command.entity))
+				{
+					command.entity += m_created;
+				}
+				if (command.type == CommandType::Add || command.type == CommandType::Set)
+				{
+					command.value += offsets[command.column];
+				}
+				m_commands.push_back(command);
+			}
+			m_created += buffer.m_created;
+			buffer.clear();
+			buffer.m_resolved.clear();
+			return out;
 		}
-	};
 
+		void playback(Pool& pool)
+		{
+			Pool::StructureLock lock{ pool, true };
+			m_resolved.clear();
+			for (EntityID index{}; index < m_created; ++index)
+			{
+				m_resolved.push_back(pool.createEntity());
+			}
 
-	class Pool
-	{
-	private:
-		ComponentRegister m_register;
-		ClusterContainer m_clusters;
-		EntityContainer m_entites;
-		Indexer<EntityID> m_indexer{ 1 };
+			std::vector<ComponentID> components(m_columns.size(), nullcomponent);
+			for (TypeID type{}; type < m_columns.size(); ++type)
+			{
+				if (m_columns[type])
+				{
+					components[type] = m_columns[type]->registerComponent(pool.m_register);
+				}
+			}
 
-		friend class Accessor;
+			for (Command& command : m_commands)
+			{
+				command.entity = resolve(command.entity);
+			}
+			auto byEntity{ [](const Command& left, const Command& right) { return left.entity < right.entity; } };
+			if (!std::is_sorted(m_commands.begin(), m_commands.end(), byEntity))
+			{
+				std::stable_sort(m_commands.begin(), m_commands.end(), byEntity);
+			}
 
-	public:
-		Pool() = default;
+			m_pending.reserve(m_commands.size());
+			for (size_t first{}; first < m_commands.size();)
+			{
+				size_t last{ first };
+				while (last < m_commands.size() && m_commands[last].entity == m_commands[first].entity)
+				{
+					++last;
+				}
+				coalesce(pool, first, last, components);
+				first = last;
+			}
 
-		~Pool() = default;
+			pool.destroyEntities(m_destroyed);
+			apply(pool);
+			clear();
+		}
 
-		EntityID createEntity()
+	private:
+		template<typename T>
+		CommandColumn<T>& getColumn(TypeID type)
 		{
-			EntityID out{ m_indexer.createIndex() };
-			m_entites.addEntity(out);
-			return out;
+			if (m_columns.size() <= type)
+			{
+				m_columns.resize(type + 1);
+			}
+			if (!m_columns[type])
+			{
+				m_columns[type] = std::make_unique<CommandColumn<T>>();
+			}
+			return static_cast<CommandColumn<T>&>(*m_columns[type]);
 		}
 
-		void destroyEntity(EntityID id)
+		void coalesce(Pool& pool, size_t first, size_t last, const std::vector<ComponentID>& components)
 		{
-			if (id == nullent)
+			EntityID id{ m_commands[first].entity };
+			if (!pool.isAlive(id))
 			{
 				return;
 			}
-			ObserverPtr<Cluster> cluster{ m_entites.getEntityCluster(id) };
-			m_entites.removeEntity(id);
-			m_indexer.releaseIndex(id);
 
+			ObserverPtr<Cluster> cluster{ pool.m_entites.getEntityCluster(id) };
+			Signature previous;
 			if (cluster.isValid())
 			{
-				cluster->removeEntity(id);
+				previous = cluster->getSignature();
 			}
-		}
 
-		template<typename T>
-		void addComponent(EntityID id, T&& component, const TypeName& name)
-		{
-			m_register.registerComponent<T>(name);
+			Signature signature{ previous };
+			size_t start{ m_pending.size() };
+			for (size_t index{ first }; index < last; ++index)
+			{
+				const Command& command{ m_commands[index] };
+				if (command.type == CommandType::Destroy)
+				{
+					m_destroyed.push_back(id);
+					m_pending.resize(start);
+					return;
+				}
 
-			ObserverPtr<Cluster>& oldCluster{ m_entites.getEntityCluster(id) };
+				ComponentID component{ components[command.column] };
+				auto found{ std::find_if(m_pending.begin() + start, m_pending.end(),
+					[component](const Pending& item) { return item.component == component; }) };
 
-			Signature signature;
-			if (oldCluster.isValid())
-			{
-				signature = oldCluster->getSignature();
+				switch (command.type)
+				{
+				case CommandType::Add:
+					signature.set(component);
+					break;
+				case CommandType::Set:
+					if (!signature.check(component))
+					{
+						continue;
+					}
+					break;
+				case CommandType::Remove:
+					signature.set(component, false);
+					if (found != m_pending.end())
+					{
+						m_pending.erase(found);
+					}
+					continue;
+				default:
+					break;
+				}
+
+				if (found != m_pending.end())
+				{
+					found->column = command.column;
+					found->value = command.value;
+				}
+				else
+				{
+					m_pending.push_back(Pending{ component, command.column, command.value, previous.check(component) });
+				}
 			}
-			signature.set(m_register.getID(name));
-			ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
 
-			if (oldCluster.isValid())
+			if (!signature.any())
 			{
-				ClusterTraits::carryEntity(id, id, *oldCluster, *newCluster);
-				checkCluster(*oldCluster);
+				if (previous.any())
+				{
+					m_destroyed.push_back(id);
+				}
+				m_pending.resize(start);
+				return;
 			}
-			else
+			if (signature == previous && m_pending.size() == start)
 			{
-				newCluster->addEntity(id);
+				return;
 			}
-			oldCluster = newCluster;
-			newCluster->addComponent(std::move(component), id, name);
+			m_moves.push_back(Move{ id, static_cast<Index>(start), static_cast<Index>(m_pending.size() - start), signature });
 		}
 
-		void removeComponent(EntityID id, const TypeName& name)
+		void apply(Pool& pool)
 		{
-			ObserverPtr<Cluster>& oldCluster{ m_entites.getEntityCluster(id) };
-			Signature signature{ oldCluster->getSignature() };
-			signature.set(m_register.getID(name), false);
+			auto byDestination{ [](const Move& left, const Move& right) { return left.signature.getWords() < right.signature.getWords(); } };
+			if (!std::is_sorted(m_moves.begin(), m_moves.end(), byDestination))
+				{
+				std::stable_sort(m_moves.begin(), m_moves.end(), byDestination);
+					}
 
-			if (!signature.any())
+			std::vector<ObserverPtr<Cluster>> touched;
+			ClusterEdge edge;
+			for (size_t first{}; first < m_moves.size();)
 			{
-				destroyEntity(id);
+				size_t last{ first };
+				while (last < m_moves.size() && m_moves[last].signature == m_moves[first].signature)
+				{
+					++last;
+				}
+
+				Cluster& destination{ *pool.m_clusters.getCluster(m_moves[first].signature, pool.m_register) };
+				edge = ClusterEdge{};
+				for (size_t index{ first }; index < last; ++index)
+				{
+					const Move& move{ m_moves[index] };
+					EntityLocation& location{ pool.m_entites.getLocation(move.entity) };
+					if (location.cluster.get() != &destination)
+					{
+						if (location.cluster.isValid())
+						{
+							if (touched.empty() || touched.back() != location.cluster || edge.destination.get() != &destination)
+							{
+							touched.push_back(location.cluster);
+								edge = ClusterTraits::bridge(*location.cluster, destination);
+							}
+							ClusterTraits::carryEntity(move.entity, pool.m_entites, edge);
+						}
+						else
+						{
+							location = EntityLocation{ &destination, destination.addEntity(move.entity) };
+						}
+					}
+
+					for (size_t item{ move.first }; item < move.first + move.count; ++item)
+					{
+						const Pending& value{ m_pending[item] };
+						IComponentArray& column{ *destination.getColumn(value.component) };
+						if (value.existing)
+						{
+							m_columns[value.column]->setIn(column, location.row, value.value);
+						}
+						else
+						{
+							m_columns[value.column]->addTo(column, value.value);
+						}
+					}
+				}
+				first = last;
 			}
-			else
+
+			std::sort(touched.begin(), touched.end(),
+				[](const ObserverPtr<Cluster>& left, const ObserverPtr<Cluster>& right) { return left.get() < right.get(); });
+			touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+			for (ObserverPtr<Cluster>& cluster : touched)
 			{
-				ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
-				ClusterTraits::carryEntity(id, id, *oldCluster, *newCluster);
-				checkCluster(*oldCluster);
-				oldCluster = newCluster;
+				pool.checkCluster(*cluster);
 			}
 		}
+	};
 
-		template<typename T>
-		T& getComponent(EntityID id, const TypeName& name)
+
+	// Each lane holds the commands one job recorded between two of its dispatches. Lanes merge
+	// in the order a serial run would have recorded them: a job's segments and dispatches in
+	// program order, and a dispatch's jobs by index, whatever thread ran them. A lane's
+	// provisional entities resolve from the playback that created them until the next merge.
+	class CommandRecorder
+	{
+	private:
+		using BufferBase = std::unique_ptr<CommandBuffer>;
+
+		struct Lane
 		{
-			return getCluster(id).getComponent<T>(id, name);
-		}
+			std::vector<size_t> key;
+			size_t serial;
+			size_t forks;
+			BufferBase buffer;
+		};
 
-		template<typename T>
-		void setComponent(EntityID id, T&& component, const TypeName& name)
+		struct Rebase
 		{
-			getCluster(id).setComponent<T>(std::move(component), id, name);
-		}
+			const CommandBuffer* lane;
+			EntityID merged;
+			EntityID count;
+			EntityID resolved;
+		};
 
-		template<typename... Args>
-		void addComponents(EntityID id, Args&&... components, const std::vector<TypeName>& names)
+		struct LocalLane
 		{
-			Signature addition{ createSignature<Args...>(names) };
-			ObserverPtr<Cluster>& oldCluster{ m_entites.getEntityCluster(id) };
+			const CommandRecorder* recorder;
+			size_t epoch;
+			size_t serial;
+			size_t forks;
+			CommandBuffer* buffer;
+		};
 
-			Signature signature;
-			if (oldCluster.isValid())
-			{
-				signature = oldCluster->getSignature();
-			}
-			signature += addition;
+		std::vector<Lane> m_lanes;
+		std::vector<BufferBase> m_spare;
+		std::vector<Rebase> m_rebased;
+		std::vector<EntityID> m_resolved;
+		CommandBuffer m_merged;
+		std::shared_mutex m_mutex;
+		size_t m_epoch{ nextEpoch() };
 
-			ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
-			if (oldCluster.isValid())
+		static inline thread_local LocalLane t_lane{};
+
+	public:
+		CommandRecorder() = default;
+
+		CommandRecorder(const CommandRecorder& recorder) = delete;
+
+		CommandRecorder& operator=(const CommandRecorder& recorder) = delete;
+
+		CommandBuffer& local()
+		{
+			JobContext& context{ JobContext::current() };
+			size_t serial{ context.getSerial() };
+			size_t forks{ context.getForks() };
+			if (t_lane.recorder == this && t_lane.epoch == m_epoch && t_lane.serial == serial && t_lane.forks == forks)
 			{
-				ClusterTraits::carryEntity(id, id, *oldCluster, *newCluster);
-				checkCluster(*oldCluster);
+				return *t_lane.buffer;
 			}
-			else
+
+			CommandBuffer* buffer{ find(serial, forks) };
+			if (!buffer)
 			{
-				newCluster->addEntity(id);
+				std::lock_guard<std::shared_mutex> lock{ m_mutex };
+				buffer = findLocked(serial, forks);
+				if (!buffer)
+				{
+					BufferBase created;
+					if (m_spare.empty())
+					{
+						created = std::make_unique<CommandBuffer>();
+					}
+					else
+					{
+						created = std::move(m_spare.back());
+						m_spare.pop_back();
+					}
+					buffer = created.get();
+					m_lanes.push_back(Lane{ context.getLane(), serial, forks, std::move(created) });
+				}
 			}
-			oldCluster = newCluster;
-			newCluster->addComponents<Args...>(std::move(components)..., id, names);
+			t_lane = LocalLane{ this, m_epoch, serial, forks, buffer };
+			return *buffer;
 		}
 
-		template <typename... Args>
-		Signature createSignature(const std::vector<TypeName>& names)
+		bool empty()
 		{
-			Signature out;
-			Index index{ 0 };
-			((m_register.registerComponent<Args>(names[index]), out.set(m_register.getID(names[index])), ++index), ...);
-			return out;
+			std::shared_lock<std::shared_mutex> lock{ m_mutex };
+			return std::all_of(m_lanes.begin(), m_lanes.end(), [](const Lane& lane) { return lane.buffer->empty(); });
 		}
 
-		Cluster& getCluster(EntityID id)
+		void merge(CommandBuffer& buffer)
 		{
-			return *m_clusters.getCluster(m_entites.getClusterID(id));
+			std::lock_guard<std::shared_mutex> lock{ m_mutex };
+			std::sort(m_lanes.begin(), m_lanes.end(), [](const Lane& left, const Lane& right)
+				{
+					return left.key != right.key ? left.key < right.key : left.serial < right.serial;
+				});
+			m_rebased.clear();
+			m_resolved.clear();
+			for (Lane& lane : m_lanes)
+			{
+				EntityID count{ lane.buffer->getCreated() };
+				EntityID merged{ buffer.merge(*lane.buffer) };
+				if (count != 0)
+				{
+					m_rebased.push_back(Rebase{ lane.buffer.get(), merged, count, EntityID{} });
+				}
+				m_spare.push_back(std::move(lane.buffer));
+			}
+			m_lanes.clear();
+			m_epoch = nextEpoch();
 		}
 
-		void copyEntity(EntityID newEntity, EntityID oldEntity)
+		void resolved(const CommandBuffer& buffer)
 		{
-			ObserverPtr<Cluster>& currentCluster{ m_entites.getEntityCluster(newEntity) };
-			ObserverPtr<Cluster> destinationCluster{ m_entites.getEntityCluster(oldEntity) };
+			std::lock_guard<std::shared_mutex> lock{ m_mutex };
+			m_resolved.clear();
+			for (Rebase& rebase : m_rebased)
+			{
+				rebase.resolved = static_cast<EntityID>(m_resolved.size());
+				for (EntityID index{}; index < rebase.count; ++index)
+				{
+					m_resolved.push_back(buffer.resolve(CommandBuffer::PROVISIONAL_BIT | (rebase.merged + index)));
+				}
+			}
+		}
 
-			if (currentCluster.isValid())
+		EntityID resolve(const CommandBuffer& lane, EntityID id)
+		{
+			if (!CommandBuffer::isProvisional(id))
 			{
-				currentCluster->removeEntity(newEntity);
+				return id;
 			}
-			if (destinationCluster.isValid())
+
+			std::shared_lock<std::shared_mutex> lock{ m_mutex };
+			EntityID index{ id & ~CommandBuffer::PROVISIONAL_BIT };
+			for (const Rebase& rebase : m_rebased)
 			{
-				ClusterTraits::copyEntity(newEntity, oldEntity, *currentCluster, *destinationCluster);
+				if (rebase.lane == &lane && index < rebase.count && rebase.resolved + index < m_resolved.size())
+				{
+					return m_resolved[rebase.resolved + index];
+				}
 			}
-			currentCluster = destinationCluster;
+			throw std::out_of_range{ "provisional entity has not been played back by this recorder" };
 		}
 
-		void carryEntity(EntityID id, ClusterID newCluster)
+		void playback(Pool& pool)
 		{
-			ObserverPtr<Cluster>& oldCluster{ m_entites.getEntityCluster(id) };
-			ObserverPtr<Cluster> destination{ m_clusters.getCluster(newCluster) };
-			ClusterTraits::carryEntity(id, id, *oldCluster, *destination);
-			checkCluster(*oldCluster);
-			oldCluster = destination;
+			merge(m_merged);
+			if (!m_merged.empty())
+			{
+				m_merged.playback(pool);
+			}
+			resolved(m_merged);
 		}
 
-		bool hasComponent(EntityID id, const TypeName& name)
+	private:
+		static size_t nextEpoch()
 		{
-			return getCluster(id).getSignature().check(m_register.getID(name));
+			static std::atomic<size_t> next{ 1 };
+			return next.fetch_add(1, std::memory_order_relaxed);
 		}
 
-	private:
-		void checkCluster(Cluster& cluster)
+		CommandBuffer* find(size_t serial, size_t forks)
 		{
-			if (cluster.empty())
-			{
-				m_clusters.removeCluster(cluster);
-			}
+			std::shared_lock<std::shared_mutex> lock{ m_mutex };
+			return findLocked(serial, forks);
+		}
+
+		CommandBuffer* findLocked(size_t serial, size_t forks)
+		{
+			auto found{ std::find_if(m_lanes.begin(), m_lanes.end(),
+				[serial, forks](const Lane& lane) { return lane.serial == serial && lane.forks == forks; }) };
+			return found == m_lanes.end() ? nullptr : found->buffer.get();
 		}
 	};
 
@@ -1482,21 +4623,49 @@ namespace CECS
 			return instance().m_pool->createEntity();
 		}
 
+		template<typename... Args>
+		static EntityRange spawn(size_t count, const Args&... components)
+		{
+			return instance().m_pool->spawn<Args...>(count, components...);
+		}
+
+		template<typename... Args, typename Generator>
+			requires std::invocable<Generator&, EntityID, Args&...>
+		static EntityRange spawn(size_t count, Generator&& generator)
+		{
+			return instance().m_pool->spawn<Args...>(count, generator);
+		}
+
+		static bool isAlive(EntityID id)
+		{
+			return instance().m_pool->isAlive(id);
+		}
+
 		static void destroyEntity(EntityID id)
 		{
 			instance().m_pool->destroyEntity(id);
 		}
 
+		static void destroyEntities(const std::vector<EntityID>& ids)
+		{
+			instance().m_pool->destroyEntities(ids);
+		}
+
+		static void destroyEntities(ObserverPtr<Query> query)
+		{
+			instance().m_pool->destroyEntities(query);
+		}
+
 		template <typename T>
 		static void addComponent(EntityID id, const T& component)
 		{
-			addComponent<T>(id, T{ component }, typeid(T).name());
+			instance().m_pool->addComponent<T>(id, T{ component });
 		}
 
 		template <typename T>
 		static void addComponent(EntityID id, T&& component)
 		{
-			addComponent<T>(id, std::move(component), typeid(T).name());
+			instance().m_pool->addComponent<T>(id, std::move(component));
 		}
 
 		template <typename T>
@@ -1511,10 +4680,22 @@ namespace CECS
 			instance().m_pool->addComponent<T>(id, std::move(component), typeName);
 		}
 
+		template<typename T>
+		static void addComponent(ObserverPtr<Query> query, const T& component)
+		{
+			instance().m_pool->addComponent<T>(query, component);
+		}
+
 		template<typename T>
 		static void removeComponent(EntityID id)
 		{
-			removeComponent(id, typeid(T).name());
+			instance().m_pool->removeComponent<T>(id);
+		}
+
+		template<typename T>
+		static void removeComponent(ObserverPtr<Query> query)
+		{
+			instance().m_pool->removeComponent<T>(query);
 		}
 
 		static void removeComponent(EntityID id, const TypeName& name)
@@ -1525,7 +4706,7 @@ namespace CECS
 		template<typename T>
 		static T& getComponent(EntityID id)
 		{
-			return getComponent<T>(id, typeid(T).name());
+			return instance().m_pool->getComponent<T>(id);
 		}
 
 		template<typename T>
@@ -1534,16 +4715,22 @@ namespace CECS
 			return instance().m_pool->getComponent<T>(id, name);
 		}
 
+		template <typename T>
+		static T readComponent(EntityID id)
+		{
+			return instance().m_pool->readComponent<T>(id);
+		}
+
 		template <typename T>
 		static void setComponent(EntityID id, const T& component)
 		{
-			setComponent<T>(id, T{ component }, typeid(T).name());
+			instance().m_pool->setComponent<T>(id, T{ component });
 		}
 
 		template <typename T>
 		static void setComponent(EntityID id, T&& component)
 		{
-			setComponent<T>(id, std::move(component), typeid(T).name());
+			instance().m_pool->setComponent<T>(id, std::move(component));
 		}
 
 		template <typename T>
@@ -1561,9 +4748,8 @@ namespace CECS
 		template<typename... Args>
 		static void addComponents(EntityID id, Args&&... components)
 		{
-			std::vector<TypeName> typeNames;
-			(typeNames.push_back(typeid(Args).name()), ...);
-			instance().m_pool->addComponents<Args...>(id, std::move(components)..., typeNames);
+			Pool& pool{ *instance().m_pool };
+			pool.addComponents<Args...>(id, std::move(components)..., pool.registerComponents<Args...>());
 		}
 
 		template<typename... Args>
@@ -1579,10 +4765,15 @@ namespace CECS
 			return out;
 		}
 
+		static EntityRange instantiate(EntityID prefab, size_t count)
+		{
+			return instance().m_pool->instantiate(prefab, count);
+		}
+
 		template<typename T>
 		static bool hasComponent(EntityID id)
 		{
-			return hasComponent(id, typeid(T).name());
+			return instance().m_pool->hasComponent<T>(id);
 		}
 
 		static bool hasComponent(EntityID id, const TypeName& name)
@@ -1593,9 +4784,7 @@ namespace CECS
 		template<typename... Args>
 		static Signature createSignature()
 		{
-			std::vector<TypeName> typeNames;
-			(typeNames.push_back(typeid(Args).name()), ...);
-			createSignature<Args...>(typeNames);
+			return instance().m_pool->createSignature<Args...>();
 		}
 
 		template<typename... Args>
@@ -1606,6 +4795,7 @@ namespace CECS
 
 		static Signature createSignature(const std::vector<TypeName>& typeNames)
 		{
+			Pool::StructureLock lock{ *instance().m_pool, false };
 			Signature out;
 			ComponentRegister& components{ getComponentRegister() };
 			for (const TypeName& name : typeNames)
@@ -1615,6 +4805,33 @@ namespace CECS
 			return out;
 		}
 
+		template<typename... Args>
+		static ObserverPtr<Query> createQuery()
+		{
+			return instance().m_pool->createQuery<Args...>();
+		}
+
+		template<typename... Args>
+		static ObserverPtr<Query> createQuery(const Signature& excluded)
+		{
+			return instance().m_pool->createQuery<Args...>(excluded);
+		}
+
+		static void destroyQuery(ObserverPtr<Query> query)
+		{
+			instance().m_pool->destroyQuery(query);
+		}
+
+		static void playback(CommandBuffer& buffer)
+		{
+			buffer.playback(*instance().m_pool);
+		}
+
+		static void playback(CommandRecorder& recorder)
+		{
+			recorder.playback(*instance().m_pool);
+		}
+
 		static ObserverPtr<Pool> getPool()
 		{
 			return instance().m_pool;
@@ -1622,12 +4839,12 @@ namespace CECS
 
 		static ClusterID getClusterID(EntityID id)
 		{
-			return instance().m_pool->m_entites.getClusterID(id);
+			return instance().m_pool->getCluster(id).getID();
 		}
 
 		static const Signature& getSignature(EntityID id)
 		{
-			return instance().m_pool->m_entites.getSignature(id);
+			return instance().m_pool->getCluster(id).getSignature();
 		}
 
 		static void carryEntity(EntityID id, ClusterID newCluster)
@@ -1652,22 +4869,20 @@ namespace CECS
 	class ClusterView
 	{
 	private:
-		template<typename... Args>
 		class ClusterIterator
 		{
 		private:
 			ObserverPtr<Cluster> m_cluster;
-			ObserverPtr<std::vector<TypeName>> m_typeNames;
 			Cluster::Cache<Args...> m_cache;
 			Index m_index;
 
 		public:
-			ClusterIterator(ObserverPtr<Cluster> cluster, std::vector<TypeName>& typeNames, Index index)
-				:m_cluster{ cluster }, m_typeNames{ typeNames }, m_index{ index }
+			ClusterIterator(ObserverPtr<Cluster> cluster, std::vector<ComponentID>& components, Index index)
+				:m_cluster{ cluster }, m_index{ index }
 			{
-				if (0 < m_cluster.isValid())
+				if (m_cluster.isValid())
 				{
-					m_cache = Cluster::Cache<Args...>(*m_cluster, *m_typeNames);
+					m_cache = Cluster::Cache<Args...>(*m_cluster, components);
 				}
 			}
 
@@ -1695,59 +4910,71 @@ namespace CECS
 		};
 
 		ObserverPtr<Cluster> m_cluster;
-		std::vector<TypeName> m_typeNames;
+		std::vector<ComponentID> m_components;
 
 	public:
 		ClusterView(ClusterID id)
 		{
-			(m_typeNames.push_back(typeid(Args)), ...);
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			ComponentRegister& components{ Accessor::getComponentRegister() };
+			m_components = { components.registerComponent<Args>()... };
 			m_cluster = Accessor::getClusterContainer().getCluster(id);
 		}
 
-		ClusterView(ClusterID id, const std::vector<TypeName> typeNames)
+		ClusterView(ClusterID id, const std::vector<TypeName>& typeNames)
 		{
-			m_typeNames = typeNames;
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			ComponentRegister& components{ Accessor::getComponentRegister() };
+			for (const TypeName& name : typeNames)
+			{
+				m_components.push_back(components.getID(name));
+			}
 			m_cluster = Accessor::getClusterContainer().getCluster(id);
 		}
 
-		ClusterIterator<Args...> begin()
+		ClusterIterator begin()
 		{
-			return ClusterIterator<Args...>{ m_cluster, m_typeNames, 0 };
+			return ClusterIterator{ m_cluster,m_components,0 };
 		}
 
-		ClusterIterator<Args...> end()
+		ClusterIterator end()
 		{
-			return ClusterIterator<Args...>{ m_cluster, m_typeNames, static_cast<Index>(m_cluster->size()) };
+			return ClusterIterator{ m_cluster,m_components,static_cast<Index>(m_cluster->size()) };
 		}
 	};
 
 
+	inline constexpr size_t MIN_BATCH_ROWS{ 1024 };
+
 	template<typename... Args>
 	class PoolView
 	{
 	private:
-		template<typename... Args>
+		struct RowRange
+		{
+			ObserverPtr<Cluster> cluster;
+			Index first;
+			Index count;
+		};
+
 		class PoolIterator
 		{
 		private:
 			ClusterContainer::ClusterWindow& m_clusters;
-			std::vector<TypeName>& m_typeNames;
-			Index m_clusterIndex;
-			Index m_itemIndex;
+			std::vector<ComponentID>& m_components;
+			size_t m_clusterIndex;
+			size_t m_itemIndex;
 			Cluster::Cache<Args...> m_cache;
 
 		public:
 			PoolIterator(
 				ClusterContainer::ClusterWindow& clusters,
-				std::vector<TypeName>& typeNames,
-				Index clusterIndex,
-				Index itemIndex)
-				:m_clusters{ clusters }, m_typeNames{ typeNames }, m_clusterIndex{ clusterIndex }, m_itemIndex{ itemIndex }
+				std::vector<ComponentID>& components, 
+				size_t clusterIndex, 
+				size_t itemIndex)
+				:m_clusters{ clusters }, m_components{components}, m_clusterIndex{ clusterIndex }, m_itemIndex{ itemIndex }
 			{
-				if (m_clusterIndex < m_clusters.size())
-				{
-					m_cache = Cluster::Cache<Args...>(*m_clusters[m_clusterIndex], m_typeNames);
-				}
+				seek();
 			}
 
 			PoolIterator& operator++()
@@ -1757,10 +4984,7 @@ namespace CECS
 				{
 					m_itemIndex = 0;
 					m_clusterIndex++;
-					if (m_clusterIndex < m_clusters.size())
-					{
-						m_cache = Cluster::Cache<Args...>(*m_clusters[m_clusterIndex], m_typeNames);
-					}
+					seek();
 				}
 				return *this;
 			}
@@ -1777,47 +5001,172 @@ namespace CECS
 
 			std::tuple<EntityID, Args&...> operator*()
 			{
-				return m_cache.getItems(m_itemIndex);
+				return m_cache.getItems(static_cast<Index>(m_itemIndex));
+			}
+
+		private:
+			void seek()
+			{
+				while (m_clusterIndex < m_clusters.size() && m_clusters[m_clusterIndex]->empty())
+				{
+					++m_clusterIndex;
+				}
+				if (m_clusterIndex < m_clusters.size())
+				{
+					m_cache = Cluster::Cache<Args...>(*m_clusters[m_clusterIndex],m_components);
+				}
 			}
 		};
 
 		ClusterContainer::ClusterWindow m_clusters;
-		std::vector<TypeName> m_typeNames;
+		std::vector<ComponentID> m_components;
+		ObserverPtr<Query> m_query;
 
 	public:
 		PoolView()
 		{
-			(m_typeNames.push_back(typeid(Args).name()), ...);
-			setup(Signature{});
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			ComponentRegister& components{ Accessor::getComponentRegister() };
+			setup(std::vector<ComponentID>{ components.registerComponent<Args>()... }, Signature{});
 		}
 
 		PoolView(const std::vector<TypeName>& needed)
 		{
-			m_typeNames = needed;
-			setup(Signature{});
+			setup(needed, Signature{});
 		}
 
 		PoolView(const std::vector<TypeName>& needed, const std::vector<TypeName>& noNeeded)
 		{
-			m_typeNames = needed;
-			setup(Accessor::createSignature(noNeeded));
+			setup(needed, Accessor::createSignature(noNeeded));
+		}
+
+		PoolView(ObserverPtr<Query> query)
+			:m_query{ query }
+		{
+		}
+
+		PoolIterator begin()
+		{
+			return PoolIterator(getClusters(), getComponents(), 0, 0);
+		}
+
+		PoolIterator end()
+		{
+			return PoolIterator(getClusters(), getComponents(), getClusters().size(), 0);
+		}
+
+		template<typename Function>
+		void eachChunk(Function&& function)
+		{
+			for (ObserverPtr<Cluster>& cluster : getClusters())
+			{
+				Cluster::Cache<Args...> cache{ *cluster, getComponents() };
+				Index size{ static_cast<Index>(cluster->size()) };
+				for (Index index{}; index < size;)
+				{
+					size_t count{ cache.contiguous(index) };
+					cache.invoke(function, index, count);
+					index += static_cast<Index>(count);
+				}
+			}
 		}
 
-		PoolIterator<Args...> begin()
+		template<typename Function>
+		void parallelEach(Function&& function, JobSystem& jobs = JobSystem::instance())
 		{
-			return PoolIterator<Args...>(m_clusters, m_typeNames, 0, 0);
+			std::vector<RowRange> ranges;
+			std::vector<size_t> batches{ 0 };
+			size_t grain{ std::max(MIN_BATCH_ROWS, size() / (jobs.size() * 4) + 1) };
+			size_t batched{};
+			for (ObserverPtr<Cluster>& cluster : getClusters())
+			{
+				Cluster::Cache<Args...> cache{ *cluster, getComponents() };
+				Index size{ static_cast<Index>(cluster->size()) };
+				for (Index index{}; index < size;)
+				{
+					Index count{ static_cast<Index>(std::min(cache.contiguous(index), grain - batched)) };
+					ranges.push_back(RowRange{ cluster, index, count });
+					index += count;
+					batched += count;
+					if (batched == grain)
+					{
+						batches.push_back(ranges.size());
+						batched = 0;
+					}
+				}
+			}
+			if (batches.back() != ranges.size())
+			{
+				batches.push_back(ranges.size());
+			}
+
+			auto each{ [&function](const EntityID* ids, Args*... components, size_t count)
+				{
+					for (size_t index{}; index < count; ++index)
+					{
+						function(ids[index], components[index]...);
+					}
+				} };
+			jobs.dispatch(batches.size() - 1, [&](size_t batch)
+				{
+					for (size_t range{ batches[batch] }; range < batches[batch + 1]; ++range)
+					{
+						Cluster::Cache<Args...> cache{ *ranges[range].cluster, getComponents() };
+						cache.invoke(each, ranges[range].first, ranges[range].count);
+					}
+				});
 		}
 
-		PoolIterator<Args...> end()
+		size_t size()
 		{
-			return PoolIterator<Args...>(m_clusters, m_typeNames, static_cast<Index>(m_clusters.size()), 0);
+			if (m_query.isValid())
+			{
+				return m_query->size();
+			}
+
+			size_t out{};
+			for (ObserverPtr<Cluster>& cluster : m_clusters)
+			{
+				out += cluster->size();
+			}
+			return out;
 		}
 
 	private:
-		void setup(const Signature& noIntersection)
+		ClusterContainer::ClusterWindow& getClusters()
+		{
+			return m_query.isValid() ? m_query->getClusters() : m_clusters;
+		}
+
+		std::vector<ComponentID>& getComponents()
+		{
+			return m_query.isValid() ? m_query->getComponents() : m_components;
+		}
+
+		void setup(const std::vector<TypeName>& needed, const Signature& noIntersection)
 		{
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			ComponentRegister& components{ Accessor::getComponentRegister() };
+			std::vector<ComponentID> componentIDs;
+			for (const TypeName& name : needed)
+			{
+				componentIDs.push_back(components.getID(name));
+			}
+			setup(componentIDs, noIntersection);
+		}
+
+		void setup(const std::vector<ComponentID>& needed, const Signature& noIntersection)
+		{
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			m_components = needed;
+			Signature subset;
+			for (ComponentID component : needed)
+			{
+				subset.set(component);
+			}
+
 			ClusterContainer& container{ Accessor::getClusterContainer() };
-			m_clusters = container.getClusters(Accessor::createSignature(m_typeNames), noIntersection);
+			m_clusters = container.getClusters(subset, noIntersection);
 		}
 	};
 
@@ -1846,8 +5195,11 @@ namespace CECS
 
 		Entity& operator=(const Entity& entity)
 		{
+			if (this != &entity)
+			{
 			Accessor::destroyEntity(m_id);
-			m_id = Accessor::copyEntity(m_id);
+				m_id = Accessor::copyEntity(entity.m_id);
+			}
 			return *this;
 		}
 
@@ -1867,13 +5219,13 @@ namespace CECS
 		template <typename T>
 		void addComponent(const T& component)
 		{
-			Accessor::addComponent<T>(m_id, T{ component }, typeid(T).name());
+			Accessor::addComponent<T>(m_id, T{ component });
 		}
 
 		template <typename T>
 		void addComponent(T&& component)
 		{
-			Accessor::addComponent<T>(m_id, std::move(component), typeid(T).name());
+			Accessor::addComponent<T>(m_id, std::move(component));
 		}
 
 		template <typename T>
@@ -1891,7 +5243,7 @@ namespace CECS
 		template<typename T>
 		void removeComponent()
 		{
-			Accessor::removeComponent(m_id, typeid(T).name());
+			Accessor::removeComponent<T>(m_id);
 		}
 
 		void removeComponent(const TypeName& name)
@@ -1902,7 +5254,7 @@ namespace CECS
 		template<typename T>
 		T& getComponent()
 		{
-			return Accessor::getComponent<T>(m_id, typeid(T).name());
+			return Accessor::getComponent<T>(m_id);
 		}
 
 		template<typename T>
@@ -1914,13 +5266,13 @@ namespace CECS
 		template <typename T>
 		void setComponent(const T& component)
 		{
-			Accessor::setComponent<T>(m_id, T{ component }, typeid(T).name());
+			Accessor::setComponent<T>(m_id, T{ component });
 		}
 
 		template <typename T>
 		void setComponent(T&& component)
 		{
-			Accessor::setComponent<T>(m_id, std::move(component), typeid(T).name());
+			Accessor::setComponent<T>(m_id, std::move(component));
 		}
 
 		template <typename T>
@@ -1938,13 +5290,13 @@ namespace CECS
 		template<typename... Args>
 		void addComponents(Args&&... components)
 		{
-			Accessor::addComponents<Args...>(m_id, std::move(components));
+			Accessor::addComponents<Args...>(m_id, std::move(components)...);
 		}
 
 		template<typename... Args>
 		void addComponents(Args&&... components, const std::vector<TypeName>& names)
 		{
-			Accessor::addComponents<Args...>(m_id, std::move(components), names);
+			Accessor::addComponents<Args...>(m_id, std::move(components)..., names);
 		}
 
 		template<typename T>
@@ -1975,8 +5327,145 @@ namespace CECS
 	};
 
 
+	class SystemAccess
+	{
+	private:
+		using TypeContainer = std::vector<TypeID>;
+
+		TypeContainer m_reads;
+		TypeContainer m_writes;
+		TypeContainer m_structural;
+		bool m_anyStructural{};
+		bool m_exclusive{};
+
+	public:
+		SystemAccess() = default;
+
+		template<typename... Args>
+		SystemAccess& read()
+		{
+			(insert(m_reads, TypeIndex::get<Args>()), ...);
+			return *this;
+		}
+
+		template<typename... Args>
+		SystemAccess& write()
+		{
+			(insert(m_writes, TypeIndex::get<Args>()), ...);
+			return *this;
+		}
+
+		template<typename... Args>
+		SystemAccess& structural()
+		{
+			if constexpr (sizeof...(Args) == 0)
+			{
+				m_anyStructural = true;
+			}
+			(insert(m_structural, TypeIndex::get<Args>()), ...);
+			return *this;
+		}
+
+		SystemAccess& exclusive()
+		{
+			m_exclusive = true;
+			return *this;
+		}
+
+		bool isExclusive() const
+		{
+			return m_exclusive;
+		}
+
+		bool isStructural() const
+		{
+			return m_anyStructural || !m_structural.empty();
+		}
+
+		bool conflicts(const SystemAccess& other) const
+		{
+			return m_exclusive || other.m_exclusive ||
+				overlaps(m_writes, other.m_writes) ||
+				overlaps(m_writes, other.m_reads) ||
+				overlaps(m_reads, other.m_writes);
+		}
+
+		bool observes(const SystemAccess& structural) const
+		{
+			if (structural.m_anyStructural)
+			{
+				return !m_reads.empty() || !m_writes.empty();
+			}
+			return overlaps(m_reads, structural.m_structural) || overlaps(m_writes, structural.m_structural);
+		}
+
+		void merge(const SystemAccess& other)
+		{
+			for (TypeID type : other.m_reads)
+			{
+				insert(m_reads, type);
+			}
+			for (TypeID type : other.m_writes)
+			{
+				insert(m_writes, type);
+			}
+			for (TypeID type : other.m_structural)
+			{
+				insert(m_structural, type);
+			}
+			m_anyStructural |= other.m_anyStructural;
+			m_exclusive |= other.m_exclusive;
+		}
+
+		void clear()
+		{
+			m_reads.clear();
+			m_writes.clear();
+			m_structural.clear();
+			m_anyStructural = false;
+			m_exclusive = false;
+		}
+
+	private:
+		static void insert(TypeContainer& types, TypeID type)
+		{
+			auto position{ std::lower_bound(types.begin(), types.end(), type) };
+			if (position == types.end() || *position != type)
+			{
+				types.insert(position, type);
+			}
+		}
+
+		static bool overlaps(const TypeContainer& left, const TypeContainer& right)
+		{
+			auto first{ left.begin() };
+			auto second{ right.begin() };
+			while (first != left.end() && second != right.end())
+			{
+				if (*first < *second)
+				{
+					++first;
+				}
+				else if (*second < *first)
+				{
+					++second;
+				}
+				else
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+
 	class ISystem
 	{
+	private:
+		CommandRecorder m_commands;
+
+		friend class Scheduler;
+
 	public:
 		ISystem() = default;
 
@@ -1990,7 +5479,219 @@ namespace CECS
 		{
 		}
 
+		virtual void declare(SystemAccess& access)
+		{
+			access.exclusive();
+		}
+
 		virtual void update() = 0;
+
+	protected:
+		CommandBuffer& commands()
+		{
+			return m_commands.local();
+		}
+
+		EntityID resolve(const CommandBuffer& lane, EntityID id)
+		{
+			return m_commands.resolve(lane, id);
+		}
+	};
+
+
+	class Scheduler
+	{
+	private:
+		using SystemBase = std::unique_ptr<ISystem>;
+
+		struct Node
+		{
+			SystemAccess access;
+			std::vector<size_t> successors;
+			size_t dependencies{};
+		};
+
+		struct Stage
+		{
+			size_t first;
+			size_t last;
+		};
+
+		std::vector<SystemBase> m_systems;
+		std::vector<Node> m_nodes;
+		std::vector<Stage> m_stages;
+		std::vector<std::atomic<size_t>> m_remaining;
+		CommandBuffer m_merged;
+		ObserverPtr<JobSystem> m_jobs;
+		bool m_dirty{};
+
+	public:
+		Scheduler(JobSystem& jobs = JobSystem::instance())
+			:m_jobs{ &jobs }
+		{
+		}
+
+		Scheduler(const Scheduler& scheduler) = delete;
+
+		Scheduler& operator=(const Scheduler& scheduler) = delete;
+
+		~Scheduler()
+		{
+			for (auto system{ m_systems.rbegin() }; system != m_systems.rend(); ++system)
+			{
+				(*system)->terminate();
+			}
+		}
+
+		template<typename T, typename... Args>
+		T& addSystem(Args&&... args)
+		{
+			std::unique_ptr<T> system{ std::make_unique<T>(std::forward<Args>(args)...) };
+			T& out{ *system };
+			out.initilize();
+			m_systems.push_back(std::move(system));
+			m_dirty = true;
+			return out;
+		}
+
+		void invalidate()
+		{
+			m_dirty = true;
+		}
+
+		size_t size() const
+		{
+			return m_systems.size();
+		}
+
+		size_t getStageCount()
+		{
+			if (m_dirty)
+			{
+				build();
+			}
+			return m_stages.size();
+		}
+
+		void update()
+		{
+			if (m_dirty)
+			{
+				build();
+			}
+
+			for (const Stage& stage : m_stages)
+			{
+				run(stage);
+				// Stages only split where a later system observes pending structural changes
+				// or runs exclusively, so every stage boundary is a required sync point.
+				for (size_t system{ stage.first }; system < stage.last; ++system)
+				{
+					m_systems[system]->m_commands.merge(m_merged);
+				}
+				if (!m_merged.empty())
+					{
+					Accessor::playback(m_merged);
+					for (size_t system{ stage.first }; system < stage.last; ++system)
+					{
+						m_systems[system]->m_commands.resolved(m_merged);
+					}
+				}
+			}
+		}
+
+	private:
+		void build()
+		{
+			m_nodes.clear();
+			m_nodes.resize(m_systems.size());
+			m_stages.clear();
+
+			SystemAccess pending;
+			size_t first{};
+			for (size_t system{}; system < m_systems.size(); ++system)
+			{
+				Node& node{ m_nodes[system] };
+				m_systems[system]->declare(node.access);
+
+				if (system != first &&
+					(node.access.isExclusive() || m_nodes[system - 1].access.isExclusive() || node.access.observes(pending)))
+				{
+					m_stages.push_back(Stage{ first, system });
+					first = system;
+					pending.clear();
+				}
+
+				for (size_t previous{ first }; previous < system; ++previous)
+				{
+					if (m_nodes[previous].access.conflicts(node.access))
+					{
+						m_nodes[previous].successors.push_back(system);
+						++node.dependencies;
+					}
+				}
+
+				if (node.access.isStructural())
+				{
+					pending.merge(node.access);
+				}
+			}
+			if (!m_systems.empty())
+			{
+				m_stages.push_back(Stage{ first, m_systems.size() });
+			}
+
+			m_remaining = std::vector<std::atomic<size_t>>(m_systems.size());
+			m_dirty = false;
+		}
+
+		void run(const Stage& stage)
+		{
+			if (stage.last - stage.first == 1 || m_jobs->size() == 1)
+			{
+				for (size_t system{ stage.first }; system < stage.last; ++system)
+				{
+					JobContext context;
+					m_systems[system]->update();
+				}
+				return;
+			}
+
+			for (size_t system{ stage.first }; system < stage.last; ++system)
+			{
+				m_remaining[system].store(m_nodes[system].dependencies, std::memory_order_relaxed);
+			}
+
+			JobCounter counter;
+			for (size_t system{ stage.first }; system < stage.last; ++system)
+			{
+				if (m_nodes[system].dependencies == 0)
+				{
+					submit(system, counter);
+				}
+			}
+			m_jobs->wait(counter);
+		}
+
+		void submit(size_t system, JobCounter& counter)
+		{
+			m_jobs->submit([this, system, &counter]() { execute(system, counter); }, counter);
+		}
+
+		void execute(size_t system, JobCounter& counter)
+		{
+			{
+				JobContext context;
+			m_systems[system]->update();
+			}
+			for (size_t successor : m_nodes[system].successors)
+			{
+				if (m_remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					submit(successor, counter);
+				}
+			}
+		}
 	};
 }
 
@@ -0,0 +1,196 @@
+#ifndef CHUNKARENA_H
+#define CHUNKARENA_H
+
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#if defined(CECS_HUGE_PAGES) && defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace CECS
+{
+#ifdef CECS_CHUNK_ALIGNMENT
+	inline constexpr size_t CHUNK_ALIGNMENT{ CECS_CHUNK_ALIGNMENT };
+#else
+	inline constexpr size_t CHUNK_ALIGNMENT{ 64 };
+#endif
+
+	inline constexpr size_t HUGE_PAGE_BYTES{ 2 * 1024 * 1024 };
+
+	struct ChunkTraits
+	{
+		static constexpr bool hugePage([[maybe_unused]] size_t bytes)
+		{
+#if defined(CECS_HUGE_PAGES) && defined(__linux__)
+			return bytes >= HUGE_PAGE_BYTES / 2;
+#else
+			return false;
+#endif
+		}
+
+		static constexpr size_t size(size_t bytes)
+		{
+			if (hugePage(bytes))
+			{
+				return (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+			}
+			return bytes;
+		}
+
+		static constexpr size_t alignment(size_t bytes, size_t alignment)
+		{
+			if (hugePage(bytes))
+			{
+				return HUGE_PAGE_BYTES;
+			}
+			return alignment;
+		}
+
+		static void* allocate(size_t bytes, size_t alignment)
+		{
+			void* out{ ::operator new(size(bytes), std::align_val_t{ ChunkTraits::alignment(bytes, alignment) }) };
+#if defined(CECS_HUGE_PAGES) && defined(__linux__)
+			if (hugePage(bytes))
+			{
+				madvise(out, size(bytes), MADV_HUGEPAGE);
+			}
+#endif
+			return out;
+		}
+
+		static void deallocate(void* chunk, size_t bytes, size_t alignment)
+		{
+			::operator delete(chunk, size(bytes), std::align_val_t{ ChunkTraits::alignment(bytes, alignment) });
+		}
+	};
+
+	struct ArenaStatistics
+	{
+		size_t systemAllocations{};
+		size_t systemDeallocations{};
+		size_t reusedChunks{};
+		size_t recycledChunks{};
+		size_t cachedChunks{};
+		size_t cachedBytes{};
+		size_t liveChunks{};
+		size_t liveBytes{};
+	};
+
+	class ChunkArena
+	{
+	private:
+		using FreeList = std::vector<void*>;
+		using FreeListContainer = std::unordered_map<size_t, FreeList>;
+
+		FreeListContainer m_freeLists;
+		ArenaStatistics m_statistics;
+		size_t m_cacheLimit{ std::numeric_limits<size_t>::max() };
+		mutable std::mutex m_mutex;
+
+	public:
+		ChunkArena() = default;
+
+		ChunkArena(const ChunkArena& arena) = delete;
+
+		ChunkArena& operator=(const ChunkArena& arena) = delete;
+
+		~ChunkArena()
+		{
+			trim();
+		}
+
+		void* allocate(size_t bytes, size_t alignment)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			++m_statistics.liveChunks;
+			m_statistics.liveBytes += bytes;
+
+			auto found{ m_freeLists.find(key(bytes, alignment)) };
+			if (found != m_freeLists.end() && !found->second.empty())
+			{
+				void* out{ found->second.back() };
+				found->second.pop_back();
+				++m_statistics.reusedChunks;
+				--m_statistics.cachedChunks;
+				m_statistics.cachedBytes -= bytes;
+				return out;
+			}
+
+			++m_statistics.systemAllocations;
+			return ChunkTraits::allocate(bytes, alignment);
+		}
+
+		void deallocate(void* chunk, size_t bytes, size_t alignment)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			--m_statistics.liveChunks;
+			m_statistics.liveBytes -= bytes;
+
+			if (m_statistics.cachedBytes + bytes > m_cacheLimit)
+			{
+				++m_statistics.systemDeallocations;
+				ChunkTraits::deallocate(chunk, bytes, alignment);
+				return;
+			}
+
+			m_freeLists[key(bytes, alignment)].push_back(chunk);
+			++m_statistics.recycledChunks;
+			++m_statistics.cachedChunks;
+			m_statistics.cachedBytes += bytes;
+		}
+
+		void trim()
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			for (auto& pair : m_freeLists)
+			{
+				size_t bytes{ pair.first & BYTES_MASK };
+				size_t alignment{ size_t{ 1 } << (pair.first >> ALIGNMENT_SHIFT) };
+				for (void* chunk : pair.second)
+				{
+					ChunkTraits::deallocate(chunk, bytes, alignment);
+					++m_statistics.systemDeallocations;
+				}
+			}
+			m_freeLists.clear();
+			m_statistics.cachedChunks = 0;
+			m_statistics.cachedBytes = 0;
+		}
+
+		void setCacheLimit(size_t bytes)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_cacheLimit = bytes;
+		}
+
+		size_t getCacheLimit() const
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			return m_cacheLimit;
+		}
+
+		ArenaStatistics getStatistics() const
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			return m_statistics;
+		}
+
+	private:
+		static constexpr size_t ALIGNMENT_SHIFT{ 58 };
+		static constexpr size_t BYTES_MASK{ (size_t{ 1 } << ALIGNMENT_SHIFT) - 1 };
+
+		static size_t key(size_t bytes, size_t alignment)
+		{
+			return bytes | (static_cast<size_t>(std::countr_zero(alignment)) << ALIGNMENT_SHIFT);
+		}
+	};
+
+}
+
+#endif
\ No newline at end of file
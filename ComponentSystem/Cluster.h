@@ -1,8 +1,11 @@
 #ifndef CLUSTER_H
 #define CLUSTER_H
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <tuple>
+#include <utility>
 #include <unordered_map>
 
 #include "Core.h"
@@ -12,23 +15,43 @@
 #include "ObserverPtr.h"
 #include "ComponentArray.h"
 #include "Algorithm.h"
+#include "ChunkArena.h"
+#include "Query.h"
+#include "SharedMutex.h"
 
 namespace CECS
 {
 
-	using ArrayContainer = std::unordered_map<TypeName,ComponentArrayBase,Hash<std::string>>;
+	class Cluster;
+
+	struct ClusterEdge
+	{
+		using ColumnPair = std::pair<ObserverPtr<IComponentArray>, ObserverPtr<IComponentArray>>;
+
+		ObserverPtr<Cluster> destination;
+		std::vector<ColumnPair> columns;
+		ObserverPtr<IComponentArray> added;
+	};
 
 	class Cluster
 	{
 	private:
-		using EntityMap = std::unordered_map<EntityID, Index, Hash<EntityID>>;
 		using ReverseMap = RigitArray<EntityID>;
+		using EdgeContainer = std::unordered_map<ComponentID, ClusterEdge, Hash<ComponentID>>;
+		using ColumnContainer = std::vector<ComponentArrayBase>;
 
-		ArrayContainer m_arrays;
-		EntityMap m_indices;
+		ColumnContainer m_columns;
+		std::vector<ComponentID> m_components;
+		std::vector<Index> m_columnIndex;
 		ReverseMap m_reverse;
 		ClusterID m_id{nullcluster};
+		ArchetypeID m_archetype{nullarchetype};
 		Signature m_signature;
+		EdgeContainer m_addEdges;
+		EdgeContainer m_removeEdges;
+		std::vector<ObserverPtr<Cluster>> m_incoming;
+		std::vector<ObserverPtr<Query>> m_queries;
+		SharedMutex m_mutex;
 
 		friend struct ClusterTraits;
 
@@ -37,71 +60,102 @@ namespace CECS
 		struct Cache
 		{
 		private:
-			std::vector<ObserverPtr<IComponentArray>> m_arrays;
+			std::array<ObserverPtr<IComponentArray>, sizeof...(Args)> m_arrays;
 			ObserverPtr<RigitArray<EntityID>> m_ids;
 
 		public:
 			Cache() = default;
 
-			Cache(Cluster& cluster, const std::vector<TypeName>& names)
+			Cache(Cluster& cluster, const std::vector<ComponentID>& components)
 				:m_ids{&cluster.m_reverse}
 			{
-				for (auto& name : names)
+				for (size_t index{}; index < m_arrays.size(); ++index)
 				{
-					m_arrays.push_back(cluster.m_arrays[name].get());
+					m_arrays[index] = cluster.getColumn(components[index]);
 				}
 			}
 
 			std::tuple<EntityID,Args&...> getItems(Index index)
 			{
-				size_t arrayIndex{ m_arrays.size() };
-				return std::tuple<EntityID, Args&...>(m_ids->get(index), (--arrayIndex, get<Args>(m_arrays[arrayIndex], index))...);
+				return getItems(index, std::index_sequence_for<Args...>{});
+			}
+
+			size_t contiguous(Index index)
+			{
+				return contiguous(index, std::index_sequence_for<Args...>{});
+			}
+
+			template<typename Function>
+			void invoke(Function& function, Index index, size_t count)
+			{
+				invoke(function, index, count, std::index_sequence_for<Args...>{});
 			}
 
 		private:
 			template <typename T>
-			T& get(ObserverPtr<IComponentArray>& base, Index index)
+			ComponentArray<T>& get(ObserverPtr<IComponentArray>& base)
+			{
+				return *static_cast<ComponentArray<T>*>(base.get());
+			}
+
+			template<size_t... Indices>
+			std::tuple<EntityID, Args&...> getItems(Index index, std::index_sequence<Indices...>)
+			{
+				return std::tuple<EntityID, Args&...>(m_ids->get(index), get<Args>(m_arrays[Indices]).getComponent(index)...);
+			}
+
+			template<size_t... Indices>
+			size_t contiguous(Index index, std::index_sequence<Indices...>)
+			{
+				return std::min({ m_ids->contiguous(index), get<Args>(m_arrays[Indices]).contiguous(index)... });
+			}
+
+			template<typename Function, size_t... Indices>
+			void invoke(Function& function, Index index, size_t count, std::index_sequence<Indices...>)
 			{
-				return static_cast<ComponentArray<T>*>(base.get())->getComponent(index);
+				function(static_cast<const EntityID*>(&m_ids->get(index)), get<Args>(m_arrays[Indices]).data(index)..., count);
 			}
 		};
 
 	public:
-		Cluster(ClusterID id, const Signature& signature)
-			:m_id{ id }, m_signature{signature}
+		Cluster(ClusterID id, ArchetypeID archetype, const Signature& signature, ObserverPtr<ChunkArena> arena = nullptr)
+			:m_reverse{ RigitAllocator<EntityID>{ arena } }, m_id{ id }, m_archetype{ archetype }, m_signature{signature}
 		{
 		}
 
 		Cluster(const Cluster& cluster)
-			:m_indices{ cluster.m_indices }, m_reverse{ cluster.m_reverse }, m_signature{cluster.m_signature}
+			:m_components{ cluster.m_components }, m_columnIndex{ cluster.m_columnIndex }, 
+			m_reverse{ cluster.m_reverse }, m_archetype{ cluster.m_archetype }, m_signature{cluster.m_signature}
 		{
-			for (auto& arrayPair : cluster.m_arrays)
+			for (const ComponentArrayBase& column : cluster.m_columns)
 			{
-				m_arrays[arrayPair.first] = arrayPair.second->copy();
+				m_columns.push_back(column->copy());
 			}
 		}
 
-		Cluster(Cluster&& cluster) noexcept = default;
-
 		Cluster& operator=(const Cluster& cluster)
 		{
-			m_indices = cluster.m_indices;
 			m_reverse = cluster.m_reverse;
+			m_archetype = cluster.m_archetype;
 			m_signature = cluster.m_signature;
+			m_components = cluster.m_components;
+			m_columnIndex = cluster.m_columnIndex;
 
-			m_arrays.clear();
-			for (auto& arrayPair : cluster.m_arrays)
+			m_columns.clear();
+			for (const ComponentArrayBase& column : cluster.m_columns)
 			{
-				m_arrays[arrayPair.first] = arrayPair.second->copy();
+				m_columns.push_back(column->copy());
 			}
 			return *this;
 		}
 
 		Cluster& operator=(Cluster&& cluster) noexcept
 		{
-			m_arrays = std::move(cluster.m_arrays);
-			m_indices = std::move(cluster.m_indices);
+			m_columns = std::move(cluster.m_columns);
+			m_components = std::move(cluster.m_components);
+			m_columnIndex = std::move(cluster.m_columnIndex);
 			m_reverse = std::move(cluster.m_reverse);
+			m_archetype = cluster.m_archetype;
 			m_signature = std::move(cluster.m_signature);
 			m_id = cluster.m_id;
 			cluster.m_id = nullcluster;
@@ -120,6 +174,11 @@ namespace CECS
 			m_id = id;
 		}
 
+		ArchetypeID getArchetype() const
+		{
+			return m_archetype;
+		}
+
 		const Signature& getSignature() const
 		{
 			return m_signature;
@@ -130,87 +189,202 @@ namespace CECS
 			m_signature = signature;
 		}
 
-		void addEntity(EntityID id)
+		ObserverPtr<ClusterEdge> getEdge(ComponentID component, bool add)
+		{
+			EdgeContainer& edges{ add ? m_addEdges : m_removeEdges };
+			auto found{ edges.find(component) };
+			if (found == edges.end())
+			{
+				return nullptr;
+			}
+			return &found->second;
+		}
+
+		Index addEntity(EntityID id)
 		{
-			Index index{ static_cast<Index>(m_indices.size()) };
-			m_indices[id] = index;
+			Index row{ static_cast<Index>(m_reverse.size()) };
 			m_reverse.pushBack(id);
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				++query->m_entities;
+			}
+			return row;
+		}
+
+		Index addEntities(EntityID first, size_t count)
+		{
+			Index row{ static_cast<Index>(m_reverse.size()) };
+			m_reverse.appendGenerated(count, [first](size_t index) { return first + static_cast<EntityID>(index); });
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				query->m_entities += count;
+			}
+			return row;
+		}
+
+		void replicate(Index row, size_t count)
+		{
+			for (ComponentArrayBase& column : m_columns)
+			{
+				column->replicate(row, count);
+			}
+		}
+
+		EntityID getEntity(Index row) const
+		{
+			return m_reverse.get(row);
+		}
+
+		const RigitArray<EntityID>& getEntities() const
+		{
+			return m_reverse;
 		}
 
 		template<typename T>
-		T& getComponent(EntityID id, const TypeName& typeName)
+		T& getComponent(Index row, ComponentID component)
 		{
-			return getArray<T>(typeName).getComponent(m_indices[id]);
+			return getArray<T>(component).getComponent(row);
 		}
 
 		template<typename T>
-		const T& getComponent(EntityID id, const TypeName& typeName) const
+		const T& getComponent(Index row, ComponentID component) const
 		{
-			return getArray<T>(typeName).getComponent(m_indices[id]);
+			return getArray<T>(component).getComponent(row);
 		}
 
 		template<typename... Args>
-		std::tuple<EntityID, Args&...> getComponents(EntityID id, const std::vector<TypeName>& typeNames)
+		std::tuple<EntityID, Args&...> getComponents(Index row, const std::vector<ComponentID>& components)
+		{
+			return Cache<Args...>{ *this, components }.getItems(row);
+		}
+
+		template<typename T>
+		void addComponent(const T& item, EntityID id, ComponentID component)
 		{
-			return getDirect<Args...>(m_indices[id], typeNames);
+			addComponent<T>(T{ item }, id, component);
 		}
 
 		template<typename T>
-		void addComponent(const T& item, EntityID id, const TypeName& typeName)
+		void addComponent(T&& item, EntityID, ComponentID component)
 		{
-			addComponent<T>(T{ item }, id, typeName);
+			getArray<T>(component).addComponent(std::move(item));
 		}
 
 		template<typename T>
-		void addComponent(T&& item, EntityID id, const TypeName& typeName)
+		void fillComponent(const T& item, size_t count, ComponentID component)
 		{
-			getArray<T>(typeName).addComponent(std::move(item));
+			getArray<T>(component).addComponents(count, item);
 		}
 
 		template<typename... Args>
-		void addComponents(Args&&... item, EntityID id, const std::vector<TypeName>& typeNames)
+		void addComponents(Args&&... item, EntityID, const std::vector<ComponentID>& components)
 		{
 			Index index{ 0 };
-			((getArray<Args>(typeNames[index]).addComponent(std::move(item)), ++index), ...);
+			((getArray<Args>(components[index]).addComponent(std::move(item)), ++index), ...);
+		}
+
+		EntityID removeEntity(Index row)
+		{
+			for (ComponentArrayBase& column : m_columns)
+			{
+				column->eraseSwapBack(row);
+			}
+
+			m_reverse.eraseSwapBack(row);
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				--query->m_entities;
+			}
+			if (row < m_reverse.size())
+			{
+				return m_reverse.get(row);
+			}
+			return nullent;
 		}
 
-		void removeEntity(EntityID id)
+		void removeEntities(const std::vector<size_t>& rows)
 		{
-			Index lastIndex{ static_cast<Index>(m_reverse.size() - 1) };
-			for (auto& keyArrayPair : m_arrays)
+			for (ComponentArrayBase& column : m_columns)
 			{
-				Index index{ m_indices[id] };
-				keyArrayPair.second->swapComponents(index, lastIndex);
-				keyArrayPair.second->removeComponent();
+				column->eraseSwapBack(rows);
 			}
+			m_reverse.eraseSwapBack(rows);
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				query->m_entities -= rows.size();
+			}
+		}
 
-			EntityID swapKey{ m_reverse[lastIndex] };
-			m_indices[swapKey] = m_indices[id];
-			m_reverse[m_indices[id]] = swapKey;
-			m_reverse.popBack();
-			m_indices.erase(id);
+		void clear()
+		{
+			for (ObserverPtr<Query>& query : m_queries)
+			{
+				query->m_entities -= m_reverse.size();
+			}
+			for (ComponentArrayBase& column : m_columns)
+			{
+				column->clear();
+			}
+			m_reverse.clear();
 		}
 
 		template<typename T>
-		void setComponent(const T& item, EntityID id, const TypeName& typeName)
+		void setComponent(const T& item, Index row, ComponentID component)
 		{
-			set<T>(T{ item }, id, typeName);
+			setComponent<T>(T{ item }, row, component);
 		}
 
 		template<typename T>
-		void setComponent(T&& item, EntityID id, const TypeName& typeName)
+		void setComponent(T&& item, Index row, ComponentID component)
+		{
+			getArray<T>(component).setComponent(row, std::move(item));
+		}
+
+		void addArray(ComponentID component, ComponentArrayBase&& rigitArray)
+		{
+			if (hasArray(component))
+			{
+				m_columns[m_columnIndex[component]] = std::move(rigitArray);
+				return;
+			}
+
+			auto position{ std::lower_bound(m_components.begin(), m_components.end(), component) };
+			Index column{ static_cast<Index>(position - m_components.begin()) };
+			m_components.insert(position, component);
+			m_columns.insert(m_columns.begin() + column, std::move(rigitArray));
+			if (m_columnIndex.size() <= component)
+			{
+				m_columnIndex.resize(component + 1, nullcolumn);
+			}
+			reindex(column);
+		}
+
+		void removeArray(ComponentID component)
 		{
-			getArray<T>(typeName).setComponent(std::move(item), m_indices[id]);
+			if (!hasArray(component))
+			{
+				return;
+			}
+
+			Index column{ m_columnIndex[component] };
+			m_components.erase(m_components.begin() + column);
+			m_columns.erase(m_columns.begin() + column);
+			m_columnIndex[component] = nullcolumn;
+			reindex(column);
 		}
 
-		void addArray(const TypeName& typeName, ComponentArrayBase&& rigitArray)
+		ObserverPtr<IComponentArray> getColumn(ComponentID component)
 		{
-			m_arrays[typeName] = std::move(rigitArray);
+			if (!hasArray(component))
+			{
+				return nullptr;
+			}
+			return m_columns[m_columnIndex[component]].get();
 		}
 
-		void removeArray(const TypeName& typeName)
+		const std::vector<ComponentID>& getComponents() const
 		{
-			m_arrays.erase(typeName);
+			return m_components;
 		}
 
 		size_t size() const
@@ -223,21 +397,40 @@ namespace CECS
 			return m_reverse.empty();
 		}
 
-		bool hasEntity(EntityID id) const
+		bool linked() const
 		{
-			return m_indices.contains(id);
+			return !m_incoming.empty();
 		}
 
-		bool hasArray(const TypeName& typeName) const
+		SharedMutex& getMutex()
 		{
-			return m_arrays.contains(typeName);
+			return m_mutex;
+		}
+
+		bool hasArray(ComponentID component) const
+		{
+			return component < m_columnIndex.size() && m_columnIndex[component] != nullcolumn;
 		}
 
 	protected:
 		template<typename T>
-		ComponentArray<T>& getArray(const TypeName& arrayIndex)
+		ComponentArray<T>& getArray(ComponentID component)
+		{
+			return *static_cast<ComponentArray<T>*>(m_columns[m_columnIndex[component]].get());
+		}
+
+		template<typename T>
+		const ComponentArray<T>& getArray(ComponentID component) const
+		{
+			return *static_cast<const ComponentArray<T>*>(m_columns[m_columnIndex[component]].get());
+		}
+
+		void reindex(Index first)
 		{
-			return *static_cast<ComponentArray<T>*>(m_arrays[arrayIndex].get());
+			for (Index column{ first }; column < m_components.size(); ++column)
+			{
+				m_columnIndex[m_components[column]] = column;
+			}
 		}
 	};
 
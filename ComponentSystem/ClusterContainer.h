@@ -1,20 +1,25 @@
 #ifndef CLUSTERCONTAINER_H
 #define CLUSTERCONTAINER_H
 
+#include <algorithm>
 #include <unordered_map>
 #include <set>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Core.h"
 
 #include "Cluster.h"
+#include "ClusterTraits.h"
 #include "Signature.h"
 #include "Indexer.h"
 #include "ComponentRegister.h"
 #include "Cluster.h"
 #include "ObserverPtr.h"
 #include "Algorithm.h"
+#include "ChunkArena.h"
+#include "Query.h"
 
 namespace CECS
 {
@@ -55,6 +60,86 @@ namespace CECS
 		}
 	};
 
+	class ArchetypeTable
+	{
+	private:
+		using IDContainer = std::unordered_map<Signature, ArchetypeID, Hash<Signature>>;
+		using ArchetypeList = std::vector<ArchetypeID>;
+
+		std::vector<Signature> m_signatures;
+		IDContainer m_ids;
+		std::vector<ArchetypeList> m_withComponent;
+
+	public:
+		ArchetypeTable() = default;
+
+		ArchetypeID intern(const Signature& signature)
+		{
+			auto found{ m_ids.find(signature) };
+			if (found != m_ids.end())
+			{
+				return found->second;
+			}
+
+			ArchetypeID id{ static_cast<ArchetypeID>(m_signatures.size()) };
+			m_signatures.push_back(signature);
+			m_ids.emplace(signature, id);
+			for (ComponentID component : signature.getComponents())
+			{
+				if (m_withComponent.size() <= component)
+				{
+					m_withComponent.resize(component + 1);
+				}
+				m_withComponent[component].push_back(id);
+			}
+			return id;
+		}
+
+		ArchetypeID find(const Signature& signature) const
+		{
+			auto found{ m_ids.find(signature) };
+			if (found == m_ids.end())
+			{
+				return nullarchetype;
+			}
+			return found->second;
+		}
+
+		const Signature& getSignature(ArchetypeID id) const
+		{
+			return m_signatures[id];
+		}
+
+		const ArchetypeList& getArchetypes(ComponentID component) const
+		{
+			static const ArchetypeList empty;
+			if (component < m_withComponent.size())
+			{
+				return m_withComponent[component];
+			}
+			return empty;
+		}
+
+		ObserverPtr<const ArchetypeList> rarest(const Signature& signature) const
+		{
+			ObserverPtr<const ArchetypeList> out;
+			for (ComponentID component : signature.getComponents())
+			{
+				const ArchetypeList& archetypes{ getArchetypes(component) };
+				if (!out.isValid() || archetypes.size() < out->size())
+				{
+					out = &archetypes;
+				}
+			}
+			return out;
+		}
+
+		size_t size() const
+		{
+			return m_signatures.size();
+		}
+	};
+
 	class ClusterContainer
 	{
 	public:
@@ -62,51 +147,81 @@ namespace CECS
 
 	private:
 		using Container = std::unordered_map<ComponentID, std::unique_ptr<Cluster>, Hash<ComponentID>>;
-		using GroupContainer = std::unordered_map<Signature, ClusterGroup, Hash<Signature>>;
+		using GroupContainer = std::vector<ClusterGroup>;
+		using QueryContainer = std::vector<std::unique_ptr<Query>>;
 
 		Container m_clusters;
+		ArchetypeTable m_archetypes;
 		GroupContainer m_groups;
+		QueryContainer m_queries;
 		Indexer<ClusterID> m_indexer{1};
+		ObserverPtr<ChunkArena> m_arena;
 
 	public:
-		ClusterContainer() = default;
+		ClusterContainer(ObserverPtr<ChunkArena> arena = nullptr)
+			:m_arena{ arena }
+		{
+		}
 
 		~ClusterContainer() = default;
 
 		ObserverPtr<Cluster> createCluster(const Signature& signature, const ComponentRegister& components)
 		{
 			ClusterID id{ m_indexer.createIndex() };
-			std::unique_ptr<Cluster> cluster{ std::make_unique<Cluster>(id,signature) };
-			for (ComponentID id : signature.getComponents())
+			ArchetypeID archetype{ m_archetypes.intern(signature) };
+			std::unique_ptr<Cluster> cluster{ std::make_unique<Cluster>(id, archetype, signature, m_arena) };
+			for (ComponentID component : signature.getComponents())
 			{
-				cluster->addArray(components.getName(id), createArray(components.getRecipie(id)));
+				cluster->addArray(component, createArray(components.getRecipie(component)));
 			}
 			ObserverPtr<Cluster> out{ cluster.get() };
 			m_clusters[id] = std::move(cluster);
 
-			if (!m_groups.contains(signature))
+			if (m_groups.size() <= archetype)
 			{
-				createGroup(signature);
+				m_groups.resize(archetype + 1);
 			}
 
-			m_groups[signature].add(id);
+			m_groups[archetype].add(id);
+
+			for (std::unique_ptr<Query>& query : m_queries)
+			{
+				if (query->matches(signature))
+				{
+					ClusterTraits::attach(*query, *out);
+				}
+			}
 
 			return out;
 		}
 
 		void removeCluster(Cluster& cluster)
 		{
+			ClusterTraits::unlink(cluster);
+			ClusterTraits::detach(cluster);
+
 			ClusterID id{ cluster.getID() };
-			ClusterGroup& group{ m_groups[cluster.getSignature()] };
-			group.remove(id);
-			if (group.empty())
-			{
-				m_groups.erase(cluster.getSignature());
-			}
+			m_groups[cluster.getArchetype()].remove(id);
 			m_clusters.erase(id);
 			m_indexer.releaseIndex(id);
 		}
 
+		void removeEmptyClusters()
+		{
+			std::vector<ObserverPtr<Cluster>> removals;
+			for (auto& pair : m_clusters)
+			{
+				if (pair.second->empty())
+				{
+					removals.push_back(pair.second.get());
+				}
+			}
+			for (ObserverPtr<Cluster>& cluster : removals)
+			{
+				removeCluster(*cluster);
+			}
+		}
+
 		ObserverPtr<Cluster> getCluster(ClusterID id)
 		{
 			return m_clusters[id].get();
@@ -114,29 +229,49 @@ namespace CECS
 
 		ObserverPtr<Cluster> getCluster(const Signature& signature, const ComponentRegister& components)
 		{
-			auto result{ m_groups.find(signature) };
-			if (result == m_groups.end())
+			ArchetypeID archetype{ m_archetypes.find(signature) };
+			if (archetype == nullarchetype || m_groups[archetype].empty())
 			{
 				return createCluster(signature,components);
 			}
 
-			return m_clusters[result->second.getDefault()].get();
+			return m_clusters[m_groups[archetype].getDefault()].get();
+		}
+
+		ClusterEdge& getEdge(Cluster& cluster, ComponentID component, bool add, const ComponentRegister& components)
+		{
+			ObserverPtr<ClusterEdge> edge{ cluster.getEdge(component, add) };
+			if (edge.isValid())
+			{
+				return *edge;
+			}
+
+			Signature signature{ cluster.getSignature() };
+			signature.set(component, add);
+			ObserverPtr<Cluster> destination;
+			if (signature.any())
+			{
+				destination = getCluster(signature, components);
+			}
+			return ClusterTraits::link(cluster, component, add, destination);
 		}
 
 		ClusterWindow getClusters(const Signature& subset, const Signature& noIntersection)
 		{
 			ClusterWindow out;
-			for (auto& pair : m_groups)
+			ObserverPtr<const std::vector<ArchetypeID>> candidates{ m_archetypes.rarest(subset) };
+			if (!candidates.isValid())
 			{
-				const Signature& check{ pair.first };
-
-				if (subset.subset(check) && !noIntersection.anyMatch(check))
+				for (ArchetypeID archetype{}; archetype < m_groups.size(); ++archetype)
 				{
-					for (ClusterID id : pair.second.getGroup())
-					{
-						out.push_back(getCluster(id));
-					}
+					collect(archetype, subset, noIntersection, out);
 				}
+				return out;
+			}
+
+			for (ArchetypeID archetype : *candidates)
+			{
+				collect(archetype, subset, noIntersection, out);
 			}
 			return out;
 		}
@@ -146,15 +281,46 @@ namespace CECS
 			return m_clusters.contains(id);
 		}
 
+		ObserverPtr<Query> createQuery(const std::vector<ComponentID>& components, const Signature& excluded)
+		{
+			std::unique_ptr<Query> query{ std::make_unique<Query>(components, excluded) };
+			for (ObserverPtr<Cluster>& cluster : getClusters(query->getRequired(), excluded))
+			{
+				ClusterTraits::attach(*query, *cluster);
+			}
+			ObserverPtr<Query> out{ query.get() };
+			m_queries.push_back(std::move(query));
+			return out;
+		}
+
+		void destroyQuery(ObserverPtr<Query> query)
+		{
+			ClusterTraits::detach(*query);
+			m_queries.erase(std::find_if(m_queries.begin(), m_queries.end(),
+				[&query](std::unique_ptr<Query>& item) { return item.get() == query.get(); }));
+		}
+
+		const ArchetypeTable& getArchetypes() const
+		{
+			return m_archetypes;
+		}
+
 	private:
 		ComponentArrayBase createArray(ObserverPtr<IRecipie> recipie) const
 		{
-			return recipie->createArray();
+			return recipie->createArray(m_arena);
 		}
 
-		void createGroup(const Signature& signature)
+		void collect(ArchetypeID archetype, const Signature& subset, const Signature& noIntersection, ClusterWindow& out)
 		{
-			m_groups[signature] = ClusterGroup{};
+			const Signature& check{ m_archetypes.getSignature(archetype) };
+			if (!m_groups[archetype].empty() && subset.subset(check) && !noIntersection.anyMatch(check))
+			{
+				for (ClusterID id : m_groups[archetype].getGroup())
+				{
+					out.push_back(getCluster(id));
+				}
+			}
 		}
 	};
 }
@@ -1,48 +1,248 @@
 #ifndef CLUSTERTRAITS_H
 #define	CLUSTERTRAITS_H
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
 #include "Core.h"
 
 #include "Cluster.h"
 #include "EntityContainer.h"
+#include "Query.h"
 
 namespace CECS
 {
 	struct ClusterTraits
 	{
-		static void carryEntity(EntityID newEntity, EntityID oldEntity, Cluster& current, Cluster& destination)
+		static void carryEntity(EntityID id, EntityContainer& entities, Cluster& destination)
+		{
+			EntityLocation& location{ entities.getLocation(id) };
+			Cluster& current{ *location.cluster };
+			Index oldRow{ location.row };
+			Index row{ destination.addEntity(id) };
+			eachSharedColumn(current, destination, [oldRow](IComponentArray& origin, IComponentArray& target)
+				{
+					target.carryFrom(origin, oldRow);
+				});
+			removeRow(current, oldRow, entities);
+			location = EntityLocation{ &destination, row };
+		}
+
+		static void carryEntity(EntityID id, EntityContainer& entities, ClusterEdge& edge)
+		{
+			EntityLocation& location{ entities.getLocation(id) };
+			Index oldRow{ location.row };
+			Index row{ edge.destination->addEntity(id) };
+			for (ClusterEdge::ColumnPair& columns : edge.columns)
+			{
+				columns.second->carryFrom(*columns.first, oldRow);
+			}
+			removeRow(*location.cluster, oldRow, entities);
+			entities.setCluster(id, edge.destination, row);
+		}
+
+		static Index carryEntities(Cluster& current, Cluster& destination, EntityContainer& entities)
+		{
+			Index first{ static_cast<Index>(destination.size()) };
+			size_t count{ current.size() };
+			if (destination.empty())
+			{
+				eachSharedColumn(current, destination, [](IComponentArray& origin, IComponentArray& target)
+					{
+						target.swapWith(origin);
+					});
+				std::swap(current.m_reverse, destination.m_reverse);
+			}
+			else
+			{
+				eachSharedColumn(current, destination, [count](IComponentArray& origin, IComponentArray& target)
+					{
+						target.carryFrom(origin, 0, count);
+					});
+				destination.m_reverse.append(current.m_reverse, 0, count);
+			}
+
+			for (ObserverPtr<Query>& query : current.m_queries)
+			{
+				query->m_entities -= count;
+			}
+			for (ObserverPtr<Query>& query : destination.m_queries)
+			{
+				query->m_entities += count;
+			}
+			for (ComponentArrayBase& column : current.m_columns)
+			{
+				column->clear();
+			}
+			current.m_reverse.clear();
+
+			for (Index row{ first }; row < destination.size(); ++row)
+			{
+				entities.getLocation(destination.m_reverse.get(row)) = EntityLocation{ &destination, row };
+			}
+			return first;
+		}
+
+		static void removeEntity(EntityID id, EntityContainer& entities)
+		{
+			releaseEntity(id, entities);
+			entities.removeEntity(id);
+		}
+
+		static void releaseEntity(EntityID id, EntityContainer& entities)
+		{
+			EntityLocation& location{ entities.getLocation(id) };
+			removeRow(*location.cluster, location.row, entities);
+			entities.setCluster(id, nullptr, 0);
+		}
+
+		static void removeEntities(Cluster& cluster, std::vector<size_t>& rows, EntityContainer& entities)
+		{
+			std::sort(rows.begin(), rows.end());
+			rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+			cluster.removeEntities(rows);
+			for (size_t row : rows)
+			{
+				if (row < cluster.size())
+				{
+					entities.getLocation(cluster.getEntity(static_cast<Index>(row))).row = static_cast<Index>(row);
+				}
+			}
+		}
+
+		static ClusterEdge bridge(Cluster& current, Cluster& destination)
+		{
+			ClusterEdge edge{ &destination, {}, {} };
+			eachSharedColumn(current, destination, [&edge](IComponentArray& origin, IComponentArray& target)
+				{
+					edge.columns.emplace_back(&origin, &target);
+				});
+			return edge;
+		}
+
+		static ClusterEdge& link(Cluster& current, ComponentID component, bool add, ObserverPtr<Cluster> destination)
 		{
-			ArrayContainer& currentArrays{ current.m_arrays };
-			Index oldIndex{ current.m_indices[oldEntity] };
-			destination.addEntity(newEntity);
-			for (auto& pair : destination.m_arrays)
+			ClusterEdge edge;
+			if (destination.isValid())
 			{
-				auto found{ currentArrays.find(pair.first) };
-				if (found != currentArrays.end())
+				edge = bridge(current, *destination);
+				if (add)
 				{
-					pair.second->carryFrom(*found->second, oldIndex);
+					edge.added = destination->getColumn(component);
 				}
+				destination->m_incoming.push_back(&current);
 			}
-			current.removeEntity(oldEntity);
+
+			Cluster::EdgeContainer& edges{ add ? current.m_addEdges : current.m_removeEdges };
+			return edges[component] = std::move(edge);
 		}
 
-		static void copyEntity(EntityID newEntity, EntityID oldEntity, Cluster& current, Cluster& destination)
+		static void unlink(Cluster& cluster)
 		{
-			ArrayContainer& currentArrays{ current.m_arrays };
-			Index oldIndex{ current.m_indices[oldEntity] };
-			destination.addEntity(newEntity);
-			for (auto& pair : destination.m_arrays)
+			auto pointsTo{ [&cluster](const auto& pair) { return pair.second.destination.get() == &cluster; } };
+			for (ObserverPtr<Cluster>& source : cluster.m_incoming)
+			{
+				std::erase_if(source->m_addEdges, pointsTo);
+				std::erase_if(source->m_removeEdges, pointsTo);
+			}
+			cluster.m_incoming.clear();
+
+			for (Cluster::EdgeContainer* edges : { &cluster.m_addEdges, &cluster.m_removeEdges })
 			{
-				auto found{ currentArrays.find(pair.first) };
-				if (found != currentArrays.end())
+				for (auto& pair : *edges)
 				{
-					pair.second->copyFrom(*found->second, oldIndex);
+					ObserverPtr<Cluster> destination{ pair.second.destination };
+					if (destination.isValid())
+					{
+						auto& incoming{ destination->m_incoming };
+						incoming.erase(std::find_if(incoming.begin(), incoming.end(),
+							[&cluster](ObserverPtr<Cluster>& source) { return source.get() == &cluster; }));
+					}
 				}
+				edges->clear();
+			}
+		}
+
+		static void attach(Query& query, Cluster& cluster)
+		{
+			query.m_clusters.push_back(&cluster);
+			query.m_entities += cluster.size();
+			cluster.m_queries.push_back(&query);
+		}
+
+		static void detach(Query& query, Cluster& cluster)
+		{
+			auto& clusters{ query.m_clusters };
+			clusters.erase(std::find_if(clusters.begin(), clusters.end(),
+				[&cluster](ObserverPtr<Cluster>& item) { return item.get() == &cluster; }));
+			query.m_entities -= cluster.size();
+
+			auto& queries{ cluster.m_queries };
+			queries.erase(std::find_if(queries.begin(), queries.end(),
+				[&query](ObserverPtr<Query>& item) { return item.get() == &query; }));
+		}
+
+		static void detach(Cluster& cluster)
+		{
+			while (!cluster.m_queries.empty())
+			{
+				detach(*cluster.m_queries.back(), cluster);
+			}
+		}
+
+		static void detach(Query& query)
+		{
+			while (!query.m_clusters.empty())
+			{
+				detach(query, *query.m_clusters.back());
+			}
+		}
+
+		static void copyEntity(EntityID newEntity, EntityID oldEntity, Cluster& current, Cluster& destination, EntityContainer& entities)
+		{
+			Index oldRow{ entities.getLocation(oldEntity).row };
+			Index row{ destination.addEntity(newEntity) };
+			eachSharedColumn(current, destination, [oldRow](IComponentArray& origin, IComponentArray& target)
+				{
+					target.copyFrom(origin, oldRow);
+				});
+			entities.setCluster(newEntity, &destination, row);
+		}
+
+	private:
+		static void removeRow(Cluster& cluster, Index row, EntityContainer& entities)
+		{
+			EntityID moved{ cluster.removeEntity(row) };
+			if (moved != nullent)
+			{
+				entities.getLocation(moved).row = row;
 			}
 		}
 
+		template<typename Function>
+		static void eachSharedColumn(Cluster& current, Cluster& destination, Function&& function)
+		{
+			size_t left{};
+			size_t right{};
+			while (left < current.m_components.size() && right < destination.m_components.size())
+			{
+				if (current.m_components[left] < destination.m_components[right])
+				{
+					++left;
+				}
+				else if (destination.m_components[right] < current.m_components[left])
+				{
+					++right;
+				}
+				else
+				{
+					function(*current.m_columns[left++], *destination.m_columns[right++]);
+				}
+			}
+		}
 	};
 
 }
 
-#endif
+#endif
\ No newline at end of file
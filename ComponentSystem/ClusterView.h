@@ -17,22 +17,20 @@ namespace CECS
 	class ClusterView
 	{
 	private:
-		template<typename... Args>
 		class ClusterIterator
 		{
 		private:
 			ObserverPtr<Cluster> m_cluster;
-			ObserverPtr<std::vector<TypeName>> m_typeNames;
 			Cluster::Cache<Args...> m_cache;
 			Index m_index;
 
 		public:
-			ClusterIterator(ObserverPtr<Cluster> cluster, std::vector<TypeName>& typeNames, Index index)
-				:m_cluster{ cluster }, m_typeNames{typeNames}, m_index{ index }
+			ClusterIterator(ObserverPtr<Cluster> cluster, std::vector<ComponentID>& components, Index index)
+				:m_cluster{ cluster }, m_index{ index }
 			{
-				if (0 < m_cluster.isValid())
+				if (m_cluster.isValid())
 				{
-					m_cache = Cluster::Cache<Args...>(*m_cluster, *m_typeNames);
+					m_cache = Cluster::Cache<Args...>(*m_cluster, components);
 				}
 			}
 
@@ -60,29 +58,36 @@ namespace CECS
 		};
 
 		ObserverPtr<Cluster> m_cluster;
-		std::vector<TypeName> m_typeNames;
+		std::vector<ComponentID> m_components;
 
 	public:
 		ClusterView(ClusterID id)
 		{
-			(m_typeNames.push_back(typeid(Args)), ...);
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			ComponentRegister& components{ Accessor::getComponentRegister() };
+			m_components = { components.registerComponent<Args>()... };
 			m_cluster = Accessor::getClusterContainer().getCluster(id);
 		}
 
-		ClusterView(ClusterID id, const std::vector<TypeName> typeNames)
+		ClusterView(ClusterID id, const std::vector<TypeName>& typeNames)
 		{
-			m_typeNames = typeNames;
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			ComponentRegister& components{ Accessor::getComponentRegister() };
+			for (const TypeName& name : typeNames)
+			{
+				m_components.push_back(components.getID(name));
+			}
 			m_cluster = Accessor::getClusterContainer().getCluster(id);
 		}
 
-		ClusterIterator<Args...> begin()
+		ClusterIterator begin()
 		{
-			return ClusterIterator<Args...>{ m_cluster,m_typeNames,0 };
+			return ClusterIterator{ m_cluster,m_components,0 };
 		}
 
-		ClusterIterator<Args...> end()
+		ClusterIterator end()
 		{
-			return ClusterIterator<Args...>{ m_cluster,m_typeNames,static_cast<Index>(m_cluster->size()) };
+			return ClusterIterator{ m_cluster,m_components,static_cast<Index>(m_cluster->size()) };
 		}
 	};
 }
@@ -0,0 +1,497 @@
+#ifndef COMMANDBUFFER_H
+#define COMMANDBUFFER_H
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Core.h"
+
+#include "Pool.h"
+#include "ClusterTraits.h"
+#include "ComponentArray.h"
+#include "ComponentRegister.h"
+#include "ObserverPtr.h"
+#include "Signature.h"
+#include "TypeIndex.h"
+
+namespace CECS
+{
+	class ICommandColumn
+	{
+	public:
+		virtual ~ICommandColumn() = default;
+
+		virtual ComponentID registerComponent(ComponentRegister& components) = 0;
+
+		virtual void addTo(IComponentArray& array, Index value) = 0;
+
+		virtual void setIn(IComponentArray& array, Index row, Index value) = 0;
+
+		virtual Index append(ICommandColumn& column) = 0;
+
+		virtual std::unique_ptr<ICommandColumn> create() const = 0;
+
+		virtual void clear() = 0;
+	};
+
+	template<typename T>
+	class CommandColumn: public ICommandColumn
+	{
+	private:
+		std::vector<T> m_values;
+
+	public:
+		CommandColumn() = default;
+
+		Index push(T&& value)
+		{
+			m_values.push_back(std::move(value));
+			return static_cast<Index>(m_values.size() - 1);
+		}
+
+		ComponentID registerComponent(ComponentRegister& components) override
+		{
+			return components.registerComponent<T>();
+		}
+
+		void addTo(IComponentArray& array, Index value) override
+		{
+			static_cast<ComponentArray<T>&>(array).addComponent(std::move(m_values[value]));
+		}
+
+		void setIn(IComponentArray& array, Index row, Index value) override
+		{
+			static_cast<ComponentArray<T>&>(array).setComponent(row, std::move(m_values[value]));
+		}
+
+		Index append(ICommandColumn& column) override
+		{
+			std::vector<T>& values{ static_cast<CommandColumn<T>&>(column).m_values };
+			Index out{ static_cast<Index>(m_values.size()) };
+			if (m_values.empty())
+			{
+				m_values.swap(values);
+			}
+			else
+			{
+				m_values.insert(m_values.end(), std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+			}
+			values.clear();
+			return out;
+		}
+
+		std::unique_ptr<ICommandColumn> create() const override
+		{
+			return std::make_unique<CommandColumn<T>>();
+		}
+
+		void clear() override
+		{
+			m_values.clear();
+		}
+	};
+
+	using CommandColumnBase = std::unique_ptr<ICommandColumn>;
+
+	class CommandBuffer
+	{
+	public:
+		static constexpr EntityID PROVISIONAL_BIT{ EntityID{ GENERATION_MASK + 1 } << GENERATION_SHIFT };
+
+	private:
+		enum class CommandType : uint8_t
+		{
+			Destroy,
+			Add,
+			Remove,
+			Set
+		};
+
+		struct Command
+		{
+			EntityID entity;
+			CommandType type;
+			TypeID column;
+			Index value;
+		};
+
+		struct Pending
+		{
+			ComponentID component;
+			TypeID column;
+			Index value;
+			bool existing;
+		};
+
+		struct Move
+		{
+			EntityID entity;
+			Index first;
+			Index count;
+			Signature signature;
+		};
+
+		std::vector<Command> m_commands;
+		std::vector<CommandColumnBase> m_columns;
+		std::vector<EntityID> m_resolved;
+		std::vector<EntityID> m_destroyed;
+		std::vector<Move> m_moves;
+		std::vector<Pending> m_pending;
+		EntityID m_created{};
+
+	public:
+		CommandBuffer() = default;
+
+		CommandBuffer(const CommandBuffer& buffer) = delete;
+
+		CommandBuffer(CommandBuffer&& buffer) noexcept = default;
+
+		CommandBuffer& operator=(const CommandBuffer& buffer) = delete;
+
+		CommandBuffer& operator=(CommandBuffer&& buffer) noexcept = default;
+
+		~CommandBuffer() = default;
+
+		EntityID createEntity()
+		{
+			return PROVISIONAL_BIT | m_created++;
+		}
+
+		void destroyEntity(EntityID id)
+		{
+			m_commands.push_back(Command{ id, CommandType::Destroy, TypeID{}, Index{} });
+		}
+
+		template<typename T>
+		void addComponent(EntityID id, const T& component)
+		{
+			addComponent<T>(id, T{ component });
+		}
+
+		template<typename T>
+		void addComponent(EntityID id, T&& component)
+		{
+			TypeID type{ TypeIndex::get<T>() };
+			m_commands.push_back(Command{ id, CommandType::Add, type, getColumn<T>(type).push(std::move(component)) });
+		}
+
+		template<typename T>
+		void removeComponent(EntityID id)
+		{
+			TypeID type{ TypeIndex::get<T>() };
+			getColumn<T>(type);
+			m_commands.push_back(Command{ id, CommandType::Remove, type, Index{} });
+		}
+
+		template<typename T>
+		void setComponent(EntityID id, const T& component)
+		{
+			setComponent<T>(id, T{ component });
+		}
+
+		template<typename T>
+		void setComponent(EntityID id, T&& component)
+		{
+			TypeID type{ TypeIndex::get<T>() };
+			m_commands.push_back(Command{ id, CommandType::Set, type, getColumn<T>(type).push(std::move(component)) });
+		}
+
+		static bool isProvisional(EntityID id)
+		{
+			return (id & PROVISIONAL_BIT) != 0;
+		}
+
+		EntityID resolve(EntityID id) const
+		{
+			if (!isProvisional(id))
+			{
+				return id;
+			}
+			EntityID index{ id & ~PROVISIONAL_BIT };
+			if (index >= m_resolved.size())
+			{
+				throw std::out_of_range{ "provisional entity has not been played back by this buffer" };
+			}
+			return m_resolved[index];
+		}
+
+		EntityID getCreated() const
+		{
+			return m_created;
+		}
+
+		bool empty() const
+		{
+			return m_commands.empty() && m_created == 0;
+		}
+
+		void clear()
+		{
+			m_commands.clear();
+			for (CommandColumnBase& column : m_columns)
+			{
+				if (column)
+				{
+					column->clear();
+				}
+			}
+			m_destroyed.clear();
+			m_moves.clear();
+			m_pending.clear();
+			m_created = 0;
+		}
+
+		EntityID merge(CommandBuffer& buffer)
+		{
+			EntityID out{ m_created };
+			if (m_columns.size() < buffer.m_columns.size())
+			{
+				m_columns.resize(buffer.m_columns.size());
+			}
+			std::vector<Index> offsets(buffer.m_columns.size());
+			for (TypeID type{}; type < buffer.m_columns.size(); ++type)
+			{
+				if (!buffer.m_columns[type])
+				{
+					continue;
+				}
+				if (!m_columns[type])
+				{
+					m_columns[type] = buffer.m_columns[type]->create();
+				}
+				offsets[type] = m_columns[type]->append(*buffer.m_columns[type]);
+			}
+
+			m_commands.reserve(m_commands.size() + buffer.m_commands.size());
+			for (Command command : buffer.m_commands)
+			{
+				if (isProvisional(command.entity))
+				{
+					command.entity += m_created;
+				}
+				if (command.type == CommandType::Add || command.type == CommandType::Set)
+				{
+					command.value += offsets[command.column];
+				}
+				m_commands.push_back(command);
+			}
+			m_created += buffer.m_created;
+			buffer.clear();
+			buffer.m_resolved.clear();
+			return out;
+		}
+
+		void playback(Pool& pool)
+		{
+			Pool::StructureLock lock{ pool, true };
+			m_resolved.clear();
+			for (EntityID index{}; index < m_created; ++index)
+			{
+				m_resolved.push_back(pool.createEntity());
+			}
+
+			std::vector<ComponentID> components(m_columns.size(), nullcomponent);
+			for (TypeID type{}; type < m_columns.size(); ++type)
+			{
+				if (m_columns[type])
+				{
+					components[type] = m_columns[type]->registerComponent(pool.m_register);
+				}
+			}
+
+			for (Command& command : m_commands)
+			{
+				command.entity = resolve(command.entity);
+			}
+			auto byEntity{ [](const Command& left, const Command& right) { return left.entity < right.entity; } };
+			if (!std::is_sorted(m_commands.begin(), m_commands.end(), byEntity))
+			{
+				std::stable_sort(m_commands.begin(), m_commands.end(), byEntity);
+			}
+
+			m_pending.reserve(m_commands.size());
+			for (size_t first{}; first < m_commands.size();)
+			{
+				size_t last{ first };
+				while (last < m_commands.size() && m_commands[last].entity == m_commands[first].entity)
+				{
+					++last;
+				}
+				coalesce(pool, first, last, components);
+				first = last;
+			}
+
+			pool.destroyEntities(m_destroyed);
+			apply(pool);
+			clear();
+		}
+
+	private:
+		template<typename T>
+		CommandColumn<T>& getColumn(TypeID type)
+		{
+			if (m_columns.size() <= type)
+			{
+				m_columns.resize(type + 1);
+			}
+			if (!m_columns[type])
+			{
+				m_columns[type] = std::make_unique<CommandColumn<T>>();
+			}
+			return static_cast<CommandColumn<T>&>(*m_columns[type]);
+		}
+
+		void coalesce(Pool& pool, size_t first, size_t last, const std::vector<ComponentID>& components)
+		{
+			EntityID id{ m_commands[first].entity };
+			if (!pool.isAlive(id))
+			{
+				return;
+			}
+
+			ObserverPtr<Cluster> cluster{ pool.m_entites.getEntityCluster(id) };
+			Signature previous;
+			if (cluster.isValid())
+			{
+				previous = cluster->getSignature();
+			}
+
+			Signature signature{ previous };
+			size_t start{ m_pending.size() };
+			for (size_t index{ first }; index < last; ++index)
+			{
+				const Command& command{ m_commands[index] };
+				if (command.type == CommandType::Destroy)
+				{
+					m_destroyed.push_back(id);
+					m_pending.resize(start);
+					return;
+				}
+
+				ComponentID component{ components[command.column] };
+				auto found{ std::find_if(m_pending.begin() + start, m_pending.end(),
+					[component](const Pending& item) { return item.component == component; }) };
+
+				switch (command.type)
+				{
+				case CommandType::Add:
+					signature.set(component);
+					break;
+				case CommandType::Set:
+					if (!signature.check(component))
+					{
+						continue;
+					}
+					break;
+				case CommandType::Remove:
+					signature.set(component, false);
+					if (found != m_pending.end())
+					{
+						m_pending.erase(found);
+					}
+					continue;
+				default:
+					break;
+				}
+
+				if (found != m_pending.end())
+				{
+					found->column = command.column;
+					found->value = command.value;
+				}
+				else
+				{
+					m_pending.push_back(Pending{ component, command.column, command.value, previous.check(component) });
+				}
+			}
+
+			if (!signature.any())
+			{
+				if (previous.any())
+				{
+					m_destroyed.push_back(id);
+				}
+				m_pending.resize(start);
+				return;
+			}
+			if (signature == previous && m_pending.size() == start)
+			{
+				return;
+			}
+			m_moves.push_back(Move{ id, static_cast<Index>(start), static_cast<Index>(m_pending.size() - start), signature });
+		}
+
+		void apply(Pool& pool)
+		{
+			auto byDestination{ [](const Move& left, const Move& right) { return left.signature.getWords() < right.signature.getWords(); } };
+			if (!std::is_sorted(m_moves.begin(), m_moves.end(), byDestination))
+			{
+				std::stable_sort(m_moves.begin(), m_moves.end(), byDestination);
+			}
+
+			std::vector<ObserverPtr<Cluster>> touched;
+			ClusterEdge edge;
+			for (size_t first{}; first < m_moves.size();)
+			{
+				size_t last{ first };
+				while (last < m_moves.size() && m_moves[last].signature == m_moves[first].signature)
+				{
+					++last;
+				}
+
+				Cluster& destination{ *pool.m_clusters.getCluster(m_moves[first].signature, pool.m_register) };
+				edge = ClusterEdge{};
+				for (size_t index{ first }; index < last; ++index)
+				{
+					const Move& move{ m_moves[index] };
+					EntityLocation& location{ pool.m_entites.getLocation(move.entity) };
+					if (location.cluster.get() != &destination)
+					{
+						if (location.cluster.isValid())
+						{
+							if (touched.empty() || touched.back() != location.cluster || edge.destination.get() != &destination)
+							{
+								touched.push_back(location.cluster);
+								edge = ClusterTraits::bridge(*location.cluster, destination);
+							}
+							ClusterTraits::carryEntity(move.entity, pool.m_entites, edge);
+						}
+						else
+						{
+							location = EntityLocation{ &destination, destination.addEntity(move.entity) };
+						}
+					}
+
+					for (size_t item{ move.first }; item < move.first + move.count; ++item)
+					{
+						const Pending& value{ m_pending[item] };
+						IComponentArray& column{ *destination.getColumn(value.component) };
+						if (value.existing)
+						{
+							m_columns[value.column]->setIn(column, location.row, value.value);
+						}
+						else
+						{
+							m_columns[value.column]->addTo(column, value.value);
+						}
+					}
+				}
+				first = last;
+			}
+
+			std::sort(touched.begin(), touched.end(),
+				[](const ObserverPtr<Cluster>& left, const ObserverPtr<Cluster>& right) { return left.get() < right.get(); });
+			touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+			for (ObserverPtr<Cluster>& cluster : touched)
+			{
+				pool.checkCluster(*cluster);
+			}
+		}
+	};
+}
+
+#endif
\ No newline at end of file
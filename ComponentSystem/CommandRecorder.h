@@ -0,0 +1,199 @@
+#ifndef COMMANDRECORDER_H
+#define COMMANDRECORDER_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "Core.h"
+
+#include "CommandBuffer.h"
+#include "JobSystem.h"
+
+namespace CECS
+{
+	// Each lane holds the commands one job recorded between two of its dispatches. Lanes merge
+	// in the order a serial run would have recorded them: a job's segments and dispatches in
+	// program order, and a dispatch's jobs by index, whatever thread ran them. A lane's
+	// provisional entities resolve from the playback that created them until the next merge.
+	class CommandRecorder
+	{
+	private:
+		using BufferBase = std::unique_ptr<CommandBuffer>;
+
+		struct Lane
+		{
+			std::vector<size_t> key;
+			size_t serial;
+			size_t forks;
+			BufferBase buffer;
+		};
+
+		struct Rebase
+		{
+			const CommandBuffer* lane;
+			EntityID merged;
+			EntityID count;
+			EntityID resolved;
+		};
+
+		struct LocalLane
+		{
+			const CommandRecorder* recorder;
+			size_t epoch;
+			size_t serial;
+			size_t forks;
+			CommandBuffer* buffer;
+		};
+
+		std::vector<Lane> m_lanes;
+		std::vector<BufferBase> m_spare;
+		std::vector<Rebase> m_rebased;
+		std::vector<EntityID> m_resolved;
+		CommandBuffer m_merged;
+		std::shared_mutex m_mutex;
+		size_t m_epoch{ nextEpoch() };
+
+		static inline thread_local LocalLane t_lane{};
+
+	public:
+		CommandRecorder() = default;
+
+		CommandRecorder(const CommandRecorder& recorder) = delete;
+
+		CommandRecorder& operator=(const CommandRecorder& recorder) = delete;
+
+		CommandBuffer& local()
+		{
+			JobContext& context{ JobContext::current() };
+			size_t serial{ context.getSerial() };
+			size_t forks{ context.getForks() };
+			if (t_lane.recorder == this && t_lane.epoch == m_epoch && t_lane.serial == serial && t_lane.forks == forks)
+			{
+				return *t_lane.buffer;
+			}
+
+			CommandBuffer* buffer{ find(serial, forks) };
+			if (!buffer)
+			{
+				std::lock_guard<std::shared_mutex> lock{ m_mutex };
+				buffer = findLocked(serial, forks);
+				if (!buffer)
+				{
+					BufferBase created;
+					if (m_spare.empty())
+					{
+						created = std::make_unique<CommandBuffer>();
+					}
+					else
+					{
+						created = std::move(m_spare.back());
+						m_spare.pop_back();
+					}
+					buffer = created.get();
+					m_lanes.push_back(Lane{ context.getLane(), serial, forks, std::move(created) });
+				}
+			}
+			t_lane = LocalLane{ this, m_epoch, serial, forks, buffer };
+			return *buffer;
+		}
+
+		bool empty()
+		{
+			std::shared_lock<std::shared_mutex> lock{ m_mutex };
+			return std::all_of(m_lanes.begin(), m_lanes.end(), [](const Lane& lane) { return lane.buffer->empty(); });
+		}
+
+		void merge(CommandBuffer& buffer)
+		{
+			std::lock_guard<std::shared_mutex> lock{ m_mutex };
+			std::sort(m_lanes.begin(), m_lanes.end(), [](const Lane& left, const Lane& right)
+				{
+					return left.key != right.key ? left.key < right.key : left.serial < right.serial;
+				});
+			m_rebased.clear();
+			m_resolved.clear();
+			for (Lane& lane : m_lanes)
+			{
+				EntityID count{ lane.buffer->getCreated() };
+				EntityID merged{ buffer.merge(*lane.buffer) };
+				if (count != 0)
+				{
+					m_rebased.push_back(Rebase{ lane.buffer.get(), merged, count, EntityID{} });
+				}
+				m_spare.push_back(std::move(lane.buffer));
+			}
+			m_lanes.clear();
+			m_epoch = nextEpoch();
+		}
+
+		void resolved(const CommandBuffer& buffer)
+		{
+			std::lock_guard<std::shared_mutex> lock{ m_mutex };
+			m_resolved.clear();
+			for (Rebase& rebase : m_rebased)
+			{
+				rebase.resolved = static_cast<EntityID>(m_resolved.size());
+				for (EntityID index{}; index < rebase.count; ++index)
+				{
+					m_resolved.push_back(buffer.resolve(CommandBuffer::PROVISIONAL_BIT | (rebase.merged + index)));
+				}
+			}
+		}
+
+		EntityID resolve(const CommandBuffer& lane, EntityID id)
+		{
+			if (!CommandBuffer::isProvisional(id))
+			{
+				return id;
+			}
+
+			std::shared_lock<std::shared_mutex> lock{ m_mutex };
+			EntityID index{ id & ~CommandBuffer::PROVISIONAL_BIT };
+			for (const Rebase& rebase : m_rebased)
+			{
+				if (rebase.lane == &lane && index < rebase.count && rebase.resolved + index < m_resolved.size())
+				{
+					return m_resolved[rebase.resolved + index];
+				}
+			}
+			throw std::out_of_range{ "provisional entity has not been played back by this recorder" };
+		}
+
+		void playback(Pool& pool)
+		{
+			merge(m_merged);
+			if (!m_merged.empty())
+			{
+				m_merged.playback(pool);
+			}
+			resolved(m_merged);
+		}
+
+	private:
+		static size_t nextEpoch()
+		{
+			static std::atomic<size_t> next{ 1 };
+			return next.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		CommandBuffer* find(size_t serial, size_t forks)
+		{
+			std::shared_lock<std::shared_mutex> lock{ m_mutex };
+			return findLocked(serial, forks);
+		}
+
+		CommandBuffer* findLocked(size_t serial, size_t forks)
+		{
+			auto found{ std::find_if(m_lanes.begin(), m_lanes.end(),
+				[serial, forks](const Lane& lane) { return lane.serial == serial && lane.forks == forks; }) };
+			return found == m_lanes.end() ? nullptr : found->buffer.get();
+		}
+	};
+}
+
+#endif
\ No newline at end of file
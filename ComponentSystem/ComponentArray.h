@@ -3,10 +3,14 @@
 
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "Core.h"
 
 #include "RigitArray.h"
+#include "ObserverPtr.h"
+#include "ChunkArena.h"
 
 namespace CECS
 {
@@ -22,10 +26,24 @@ namespace CECS
 
 		virtual void swapComponents(Index left, Index right) = 0;
 
+		virtual void eraseSwapBack(Index index) = 0;
+
+		virtual void eraseSwapBack(const std::vector<size_t>& sortedIndices) = 0;
+
 		virtual void carryFrom(IComponentArray& origin, Index index) = 0;
 
 		virtual void copyFrom(const IComponentArray& origin, Index index) = 0;
 
+		virtual void carryFrom(IComponentArray& origin, Index first, size_t count) = 0;
+
+		virtual void copyFrom(const IComponentArray& origin, Index first, size_t count) = 0;
+
+		virtual void replicate(Index index, size_t count) = 0;
+
+		virtual void swapWith(IComponentArray& other) = 0;
+
+		virtual void clear() = 0;
+
 		virtual ComponentArrayBase copy() const = 0;
 
 	};
@@ -39,6 +57,10 @@ namespace CECS
 	public:
 		ComponentArray() = default;
 
+		ComponentArray(ObserverPtr<ChunkArena> arena) : components{ RigitAllocator<Component>{ arena } }
+		{
+		}
+
 		ComponentArray(const RigitArray<Component>& rigitArray) : components{ rigitArray }
 		{
 		}
@@ -55,7 +77,7 @@ namespace CECS
 
 		void addComponent(const Component& component)
 		{
-			components.pushBack(Component{ component });
+			components.pushBack(component);
 		}
 
 		void addComponent(Component&& component)
@@ -63,6 +85,11 @@ namespace CECS
 			components.pushBack(std::move(component));
 		}
 
+		void addComponents(size_t count, const Component& component)
+		{
+			components.appendFilled(count, component);
+		}
+
 		void removeComponent() override
 		{
 			components.popBack();
@@ -78,6 +105,16 @@ namespace CECS
 			return components.get(index);
 		}
 
+		Component* data(Index index)
+		{
+			return &components.get(index);
+		}
+
+		size_t contiguous(Index index) const
+		{
+			return components.contiguous(index);
+		}
+
 		void setComponent(Index index, Component&& component)
 		{
 			components.set(index, std::move(component));
@@ -88,6 +125,16 @@ namespace CECS
 			components.swap(left, right);
 		}
 
+		void eraseSwapBack(Index index) override
+		{
+			components.eraseSwapBack(index);
+		}
+
+		void eraseSwapBack(const std::vector<size_t>& sortedIndices) override
+		{
+			components.eraseSwapBack(sortedIndices);
+		}
+
 		void carryFrom(IComponentArray& origin, Index index) override
 		{
 			addComponent(std::move(static_cast<ComponentArray<Component>&>(origin).getComponent(index)));
@@ -95,7 +142,32 @@ namespace CECS
 
 		void copyFrom(const IComponentArray& origin, Index index) override
 		{
-			addComponent(Component{ static_cast<const ComponentArray<Component>&>(origin).getComponent(index) });
+			addComponent(static_cast<const ComponentArray<Component>&>(origin).getComponent(index));
+		}
+
+		void carryFrom(IComponentArray& origin, Index first, size_t count) override
+		{
+			components.appendMoved(static_cast<ComponentArray<Component>&>(origin).components, first, count);
+		}
+
+		void copyFrom(const IComponentArray& origin, Index first, size_t count) override
+		{
+			components.append(static_cast<const ComponentArray<Component>&>(origin).components, first, count);
+		}
+
+		void replicate(Index index, size_t count) override
+		{
+			components.appendFilled(count, components.get(index));
+		}
+
+		void swapWith(IComponentArray& other) override
+		{
+			std::swap(components, static_cast<ComponentArray<Component>&>(other).components);
+		}
+
+		void clear() override
+		{
+			components.clear();
 		}
 
 		ComponentArrayBase copy() const override
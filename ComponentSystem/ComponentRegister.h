@@ -3,6 +3,7 @@
 
 #include <unordered_map>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 #include "Core.h"
@@ -11,22 +12,24 @@
 #include "RigitArray.h"
 #include "ObserverPtr.h"
 #include "ComponentArray.h"
+#include "ChunkArena.h"
+#include "TypeIndex.h"
 
 namespace CECS
 {
 	class IRecipie
 	{
 	public:
-		virtual ComponentArrayBase createArray() const = 0;
+		virtual ComponentArrayBase createArray(ObserverPtr<ChunkArena> arena) const = 0;
 	};
 
 	template<typename T>
 	class Recipie: public IRecipie
 	{
 	public:
-		ComponentArrayBase createArray() const override
+		ComponentArrayBase createArray(ObserverPtr<ChunkArena> arena) const override
 		{
-			return std::make_unique<ComponentArray<T>>();
+			return std::make_unique<ComponentArray<T>>(arena);
 		}
 	};
 
@@ -42,20 +45,55 @@ namespace CECS
 		RecipieContainer m_recipies;
 		IDConverter m_componentIDS;
 		std::vector<TypeName> m_typeNames;
+		std::vector<ComponentID> m_types;
 
 	public:
 		ComponentRegister() = default;
 
 		template<typename T>
-		void registerComponent(const TypeName& name)
+		ComponentID registerComponent()
 		{
-			if (!registered(name))
+			TypeID type{ TypeIndex::get<T>() };
+			if (type < m_types.size() && m_types[type] != nullcomponent)
 			{
-				Index id{ m_indexer.createIndex() };
-				m_componentIDS[name] = id;
-				m_typeNames.push_back(name);
-				m_recipies[id] = std::make_unique<Recipie<T>>();
+				return m_types[type];
 			}
+
+			ComponentID id{ registerComponent<T>(typeid(T).name()) };
+			if (m_types.size() <= type)
+			{
+				m_types.resize(type + 1, nullcomponent);
+			}
+			m_types[type] = id;
+			return id;
+		}
+
+		template<typename T>
+		ComponentID registerComponent(const TypeName& name)
+		{
+			auto found{ m_componentIDS.find(name) };
+			if (found != m_componentIDS.end())
+			{
+				return found->second;
+			}
+
+			if (m_typeNames.size() >= MAX_COMPONENTS)
+			{
+				throw std::length_error{ "component count exceeds MAX_COMPONENTS" };
+			}
+
+			Index id{ m_indexer.createIndex() };
+			m_componentIDS[name] = id;
+			m_typeNames.push_back(name);
+			m_recipies[id] = std::make_unique<Recipie<T>>();
+			return id;
+		}
+
+		template<typename T>
+		bool registered() const
+		{
+			TypeID type{ TypeIndex::get<T>() };
+			return type < m_types.size() && m_types[type] != nullcomponent;
 		}
 
 		bool registered(const TypeName& name) const
@@ -63,6 +101,13 @@ namespace CECS
 			return m_componentIDS.contains(name);
 		}
 
+		template<typename T>
+		ComponentID getID() const
+		{
+			TypeID type{ TypeIndex::get<T>() };
+			return type < m_types.size() ? m_types[type] : nullcomponent;
+		}
+
 		ComponentID getID(const TypeName& name) const
 		{
 			return m_componentIDS.at(name);
@@ -2,21 +2,37 @@
 #define CORE_H
 
 #include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
 
 namespace CECS
 {
-	using EntityID = uint32_t;
+	using EntityID = uint64_t;
+	using Generation = uint32_t;
 	using ComponentID = uint32_t;
+	using TypeID = uint32_t;
 	using ClusterID = uint16_t;
+	using ArchetypeID = uint32_t;
 	using Index = uint32_t;
 	using TypeName = std::string;
 
 	inline constexpr EntityID nullent{ 0 };
 	inline constexpr ClusterID nullcluster{ 0 };
+	inline constexpr ArchetypeID nullarchetype{ std::numeric_limits<ArchetypeID>::max() };
+	inline constexpr ComponentID nullcomponent{ std::numeric_limits<ComponentID>::max() };
+	inline constexpr Index nullcolumn{ std::numeric_limits<Index>::max() };
+
+	inline constexpr size_t GENERATION_SHIFT{ 32 };
+	inline constexpr Generation GENERATION_MASK{ std::numeric_limits<Generation>::max() >> 1 };
 
 	inline constexpr size_t BITSET_SIZE{ 64 };
+
+#ifdef CECS_MAX_COMPONENTS
+	inline constexpr size_t MAX_COMPONENTS{ CECS_MAX_COMPONENTS };
+#else
+	inline constexpr size_t MAX_COMPONENTS{ 256 };
+#endif
 }
 
 #endif
\ No newline at end of file
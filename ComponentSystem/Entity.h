@@ -1,7 +1,7 @@
 #ifndef ENTITY_H 
 #define	ENTITY_H
 
-#include "Core.h";
+#include "Core.h"
 
 #include "Accessor.h"
 
@@ -31,8 +31,11 @@ namespace CECS
 
 		Entity& operator=(const Entity& entity)
 		{
-			Accessor::destroyEntity(m_id);
-			m_id = Accessor::copyEntity(m_id);
+			if (this != &entity)
+			{
+				Accessor::destroyEntity(m_id);
+				m_id = Accessor::copyEntity(entity.m_id);
+			}
 			return *this;
 		}
 
@@ -52,13 +55,13 @@ namespace CECS
 		template <typename T>
 		void addComponent(const T& component)
 		{
-			Accessor::addComponent<T>(m_id, T{ component }, typeid(T).name());
+			Accessor::addComponent<T>(m_id, T{ component });
 		}
 
 		template <typename T>
 		void addComponent(T&& component)
 		{
-			Accessor::addComponent<T>(m_id, std::move(component), typeid(T).name());
+			Accessor::addComponent<T>(m_id, std::move(component));
 		}
 
 		template <typename T>
@@ -76,7 +79,7 @@ namespace CECS
 		template<typename T>
 		void removeComponent()
 		{
-			Accessor::removeComponent(m_id, typeid(T).name());
+			Accessor::removeComponent<T>(m_id);
 		}
 
 		void removeComponent(const TypeName& name)
@@ -87,7 +90,7 @@ namespace CECS
 		template<typename T>
 		T& getComponent()
 		{
-			return Accessor::getComponent<T>(m_id, typeid(T).name());
+			return Accessor::getComponent<T>(m_id);
 		}
 
 		template<typename T>
@@ -99,13 +102,13 @@ namespace CECS
 		template <typename T>
 		void setComponent(const T& component)
 		{
-			Accessor::setComponent<T>(m_id, T{ component }, typeid(T).name());
+			Accessor::setComponent<T>(m_id, T{ component });
 		}
 
 		template <typename T>
 		void setComponent(T&& component)
 		{
-			Accessor::setComponent<T>(m_id, std::move(component), typeid(T).name());
+			Accessor::setComponent<T>(m_id, std::move(component));
 		}
 
 		template <typename T>
@@ -123,13 +126,13 @@ namespace CECS
 		template<typename... Args>
 		void addComponents(Args&&... components)
 		{
-			Accessor::addComponents<Args...>(m_id, std::move(components));
+			Accessor::addComponents<Args...>(m_id, std::move(components)...);
 		}
 
 		template<typename... Args>
 		void addComponents(Args&&... components, const std::vector<TypeName>& names)
 		{
-			Accessor::addComponents<Args...>(m_id, std::move(components),names);
+			Accessor::addComponents<Args...>(m_id, std::move(components)..., names);
 		}
 
 		template<typename T>
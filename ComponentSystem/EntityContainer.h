@@ -1,63 +1,129 @@
 #ifndef ENTITYCONTAINER_H
 #define	ENTITYCONTAINER_H
 
+#include <atomic>
+#include <cassert>
+
 #include "Core.h"
 
+#include "Cluster.h"
 #include "Signature.h"
 #include "RigitArray.h"
+#include "ObserverPtr.h"
+#include "ChunkArena.h"
 
 namespace CECS
 {
+	struct EntityLocation
+	{
+		ObserverPtr<Cluster> cluster;
+		Index row{};
+	};
+
 	class EntityContainer
 	{
 	private:
-		using EntityClusterMap = RigitArray<ObserverPtr<Cluster>>;
+		using EntityLocationMap = RigitArray<EntityLocation>;
+		using GenerationMap = RigitArray<Generation>;
 
-		EntityClusterMap m_entites;
+		EntityLocationMap m_entites;
+		GenerationMap m_generations;
 
 	public:
-		EntityContainer()
+		EntityContainer(ObserverPtr<ChunkArena> arena = nullptr)
+			:m_entites{ RigitAllocator<EntityLocation>{ arena } }, m_generations{ RigitAllocator<Generation>{ arena } }
 		{
-			m_entites.pushBack(nullptr);
+			m_entites.pushBack(EntityLocation{});
+			m_generations.pushBack(0);
 		}
 
 		~EntityContainer() = default;
 
-		void addEntity(EntityID id, ObserverPtr<Cluster> cluster= nullptr)
+		static Index getIndex(EntityID id)
+		{
+			return static_cast<Index>(id);
+		}
+
+		static Generation getGeneration(EntityID id)
+		{
+			return static_cast<Generation>(id >> GENERATION_SHIFT);
+		}
+
+		static EntityID createID(Index index, Generation generation)
+		{
+			return (EntityID{ generation } << GENERATION_SHIFT) | index;
+		}
+
+		EntityID addEntity(EntityID id, ObserverPtr<Cluster> cluster= nullptr, Index row = 0)
 		{
-			if (id < m_entites.size())
+			Index index{ getIndex(id) };
+			if (index < m_entites.size())
 			{
-				m_entites[id] = cluster;
+				m_entites[index] = EntityLocation{ cluster, row };
 			}
 			else 
 			{
-				m_entites.pushBack(cluster);
+				m_entites.pushBack(EntityLocation{ cluster, row });
+				m_generations.pushBack(0);
 			}
+			return createID(index, m_generations[index]);
+		}
+
+		void addEntities(EntityID first, size_t count, ObserverPtr<Cluster> cluster, Index row)
+		{
+			assert(getIndex(first) == m_entites.size());
+			m_entites.appendGenerated(count, [cluster, row](size_t index)
+				{
+					return EntityLocation{ cluster, row + static_cast<Index>(index) };
+				});
+			m_generations.appendFilled(count, 0);
 		}
 
 		void removeEntity(EntityID id)
 		{
-			m_entites[id] = nullptr;
+			Index index{ getIndex(id) };
+			setCluster(id, nullptr, 0);
+			std::atomic_ref<Generation> generation{ m_generations[index] };
+			generation.store((generation.load(std::memory_order_relaxed) + 1) & GENERATION_MASK, std::memory_order_release);
+		}
+
+		bool isAlive(EntityID id) const
+		{
+			Index index{ getIndex(id) };
+			return id != nullent && index < m_generations.size() &&
+				std::atomic_ref<Generation>{ const_cast<Generation&>(m_generations[index]) }.load(std::memory_order_acquire) == getGeneration(id);
+		}
+
+		EntityLocation& getLocation(EntityID id)
+		{
+			return m_entites[getIndex(id)];
 		}
 
 		ObserverPtr<Cluster>& getEntityCluster(EntityID id)
 		{
-			return m_entites[id];
+			return m_entites[getIndex(id)].cluster;
+		}
+
+		ObserverPtr<Cluster> loadCluster(EntityID id)
+		{
+			return std::atomic_ref<ObserverPtr<Cluster>>{ m_entites[getIndex(id)].cluster }.load(std::memory_order_acquire);
 		}
 
 		const Signature& getSignature(EntityID id)
 		{
-			return m_entites[id]->getSignature();
+			return m_entites[getIndex(id)].cluster->getSignature();
 		}
 
 		ClusterID getClusterID(EntityID id)
 		{
-			return m_entites[id]->getID();
+			return m_entites[getIndex(id)].cluster->getID();
 		}
 
-		void setCluster(EntityID id, ObserverPtr<Cluster> cluster)
+		void setCluster(EntityID id, ObserverPtr<Cluster> cluster, Index row)
 		{
-			m_entites[id] = cluster;
+			EntityLocation& location{ m_entites[getIndex(id)] };
+			location.row = row;
+			std::atomic_ref<ObserverPtr<Cluster>>{ location.cluster }.store(cluster, std::memory_order_release);
 		}
 	};
 }
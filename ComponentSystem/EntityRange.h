@@ -0,0 +1,116 @@
+#ifndef ENTITYRANGE_H
+#define ENTITYRANGE_H
+
+#include <cstddef>
+#include <iterator>
+
+#include "Core.h"
+
+namespace CECS
+{
+	class EntityRange
+	{
+	public:
+		class Iterator
+		{
+		private:
+			EntityID m_id{ nullent };
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = EntityID;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const EntityID*;
+			using reference = EntityID;
+
+			Iterator() = default;
+
+			Iterator(EntityID id)
+				:m_id{ id }
+			{
+			}
+
+			EntityID operator*() const
+			{
+				return m_id;
+			}
+
+			Iterator& operator++()
+			{
+				++m_id;
+				return *this;
+			}
+
+			Iterator operator++(int)
+			{
+				Iterator out{ *this };
+				++m_id;
+				return out;
+			}
+
+			bool operator==(const Iterator& right) const
+			{
+				return m_id == right.m_id;
+			}
+
+			bool operator!=(const Iterator& right) const
+			{
+				return !(*this == right);
+			}
+		};
+
+	private:
+		EntityID m_first{ nullent };
+		size_t m_count{};
+
+	public:
+		EntityRange() = default;
+
+		EntityRange(EntityID first, size_t count)
+			:m_first{ first }, m_count{ count }
+		{
+		}
+
+		EntityID operator[](size_t index) const
+		{
+			return m_first + static_cast<EntityID>(index);
+		}
+
+		EntityID front() const
+		{
+			return m_first;
+		}
+
+		EntityID back() const
+		{
+			return (*this)[m_count - 1];
+		}
+
+		bool contains(EntityID id) const
+		{
+			return id >= m_first && id - m_first < m_count;
+		}
+
+		size_t size() const
+		{
+			return m_count;
+		}
+
+		bool empty() const
+		{
+			return m_count == 0;
+		}
+
+		Iterator begin() const
+		{
+			return Iterator{ m_first };
+		}
+
+		Iterator end() const
+		{
+			return Iterator{ (*this)[m_count] };
+		}
+	};
+}
+
+#endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define	INDEXER_H
 
 #include "RigitArray.h"
+#include "ObserverPtr.h"
+#include "ChunkArena.h"
 
 namespace CECS
 {
@@ -16,8 +18,8 @@ namespace CECS
 		EmptyIndexContainer m_emptyIndices;
 
 	public:
-		Indexer(T start = 0)
-			:m_nextIndex{start}
+		Indexer(T start = 0, ObserverPtr<ChunkArena> arena = nullptr)
+			:m_nextIndex{start}, m_emptyIndices{ RigitAllocator<T>{ arena } }
 		{
 		}
 
@@ -34,11 +36,23 @@ namespace CECS
 			return out;
 		}
 
+		T createIndices(size_t count)
+		{
+			T out{ m_nextIndex };
+			m_nextIndex += static_cast<T>(count);
+			return out;
+		}
+
 		void releaseIndex(T index)
 		{
 			m_emptyIndices.pushBack(index);
 		}
 
+		void releaseIndices(const RigitArray<T>& indices)
+		{
+			m_emptyIndices.append(indices, 0, indices.size());
+		}
+
 	};
 }
 
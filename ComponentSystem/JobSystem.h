@@ -0,0 +1,399 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Core.h"
+
+#include "ObserverPtr.h"
+
+namespace CECS
+{
+	class JobCounter
+	{
+	private:
+		std::atomic<size_t> m_count{};
+		std::atomic<bool> m_failed{};
+		std::exception_ptr m_exception;
+
+		friend class JobSystem;
+
+	public:
+		JobCounter() = default;
+
+		JobCounter(const JobCounter& counter) = delete;
+
+		JobCounter& operator=(const JobCounter& counter) = delete;
+
+		bool done() const
+		{
+			return m_count.load(std::memory_order_acquire) == 0;
+		}
+
+		size_t pending() const
+		{
+			return m_count.load(std::memory_order_acquire);
+		}
+
+	private:
+		void fail(std::exception_ptr exception)
+		{
+			if (!m_failed.exchange(true, std::memory_order_acq_rel))
+			{
+				m_exception = std::move(exception);
+			}
+		}
+
+		void rethrow()
+		{
+			if (!m_failed.load(std::memory_order_acquire))
+			{
+				return;
+			}
+			std::exception_ptr exception{ std::exchange(m_exception, nullptr) };
+			m_failed.store(false, std::memory_order_relaxed);
+			std::rethrow_exception(exception);
+		}
+	};
+
+	class JobContext
+	{
+	private:
+		const std::vector<size_t>* m_path{};
+		size_t m_index{};
+		size_t m_forks{};
+		size_t m_serial{ nextSerial() };
+		JobContext* m_previous{ t_current };
+
+		static inline thread_local JobContext* t_current{};
+
+	public:
+		JobContext()
+		{
+			t_current = this;
+		}
+
+		JobContext(const std::vector<size_t>& path, size_t index)
+			:m_path{ &path }, m_index{ index }
+		{
+			t_current = this;
+		}
+
+		JobContext(const JobContext& context) = delete;
+
+		JobContext& operator=(const JobContext& context) = delete;
+
+		~JobContext()
+		{
+			t_current = m_previous;
+		}
+
+		static JobContext& current()
+		{
+			if (!t_current)
+			{
+				static thread_local JobContext root;
+				t_current = &root;
+			}
+			return *t_current;
+		}
+
+		size_t getSerial() const
+		{
+			return m_serial;
+		}
+
+		size_t getForks() const
+		{
+			return m_forks;
+		}
+
+		std::vector<size_t> getLane() const
+		{
+			return getPath(2 * m_forks);
+		}
+
+		std::vector<size_t> fork()
+		{
+			return getPath(2 * m_forks++ + 1);
+		}
+
+	private:
+		static size_t nextSerial()
+		{
+			static std::atomic<size_t> next{ 1 };
+			return next.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::vector<size_t> getPath(size_t segment) const
+		{
+			std::vector<size_t> out;
+			if (m_path)
+			{
+				out.reserve(m_path->size() + 2);
+				out.assign(m_path->begin(), m_path->end());
+				out.push_back(m_index);
+			}
+			out.push_back(segment);
+			return out;
+		}
+	};
+
+	class JobSystem
+	{
+	private:
+		using Job = std::function<void()>;
+
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		using QueueContainer = std::vector<std::unique_ptr<WorkQueue>>;
+
+		QueueContainer m_queues;
+		std::vector<std::thread> m_threads;
+		std::atomic<size_t> m_queued{};
+		std::atomic<size_t> m_sleepers{};
+		std::atomic<bool> m_running{ true };
+		std::mutex m_sleep;
+		std::condition_variable m_wake;
+
+		static inline thread_local ObserverPtr<JobSystem> t_system;
+		static inline thread_local size_t t_queue{};
+
+	public:
+		JobSystem(size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1))
+		{
+			for (size_t queue{}; queue < std::max<size_t>(threads, 1); ++queue)
+			{
+				m_queues.push_back(std::make_unique<WorkQueue>());
+			}
+			for (size_t queue{ 1 }; queue < m_queues.size(); ++queue)
+			{
+				m_threads.emplace_back([this, queue]() { work(queue); });
+			}
+		}
+
+		JobSystem(const JobSystem& jobs) = delete;
+
+		JobSystem& operator=(const JobSystem& jobs) = delete;
+
+		~JobSystem()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ m_sleep };
+				m_running = false;
+			}
+			m_wake.notify_all();
+			for (std::thread& thread : m_threads)
+			{
+				thread.join();
+			}
+		}
+
+		static JobSystem& instance()
+		{
+			static JobSystem jobs;
+
+			return jobs;
+		}
+
+		size_t size() const
+		{
+			return m_queues.size();
+		}
+
+		template<typename Function>
+		void submit(Function&& function, JobCounter& counter)
+		{
+			counter.m_count.fetch_add(1, std::memory_order_relaxed);
+			WorkQueue& queue{ *m_queues[ownQueue()] };
+			{
+				std::lock_guard<std::mutex> lock{ queue.mutex };
+				queue.jobs.emplace_back([function{ std::forward<Function>(function) }, &counter, path{ JobContext::current().fork() }]() mutable
+					{
+						{
+							JobContext context{ path, 0 };
+							try
+							{
+								function();
+							}
+							catch (...)
+							{
+								counter.fail(std::current_exception());
+							}
+						}
+						counter.m_count.fetch_sub(1, std::memory_order_release);
+					});
+				m_queued.fetch_add(1);
+			}
+			wake();
+		}
+
+		void wait(JobCounter& counter)
+		{
+			while (!counter.done())
+			{
+				if (!runOne(ownQueue()))
+				{
+					std::this_thread::yield();
+				}
+			}
+			counter.rethrow();
+		}
+
+		template<typename Function>
+		void dispatch(size_t count, Function&& function)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			JobCounter counter;
+			counter.m_count.store(count, std::memory_order_relaxed);
+			std::vector<size_t> path{ JobContext::current().fork() };
+			WorkQueue& queue{ *m_queues[ownQueue()] };
+			{
+				std::lock_guard<std::mutex> lock{ queue.mutex };
+				for (size_t job{}; job < count; ++job)
+				{
+					queue.jobs.emplace_back([&function, &counter, &path, job]()
+						{
+							{
+								JobContext context{ path, job };
+								try
+								{
+									function(job);
+								}
+								catch (...)
+								{
+									counter.fail(std::current_exception());
+								}
+							}
+							counter.m_count.fetch_sub(1, std::memory_order_release);
+						});
+				}
+				m_queued.fetch_add(count);
+			}
+			wake();
+			wait(counter);
+		}
+
+		template<typename Function>
+		void parallelFor(size_t count, size_t grain, Function&& function)
+		{
+			grain = std::max<size_t>(grain, 1);
+			dispatch((count + grain - 1) / grain, [&function, count, grain](size_t job)
+				{
+					size_t first{ job * grain };
+					function(first, std::min(first + grain, count));
+				});
+		}
+
+		template<typename Function>
+		void parallelFor(size_t count, Function&& function)
+		{
+			parallelFor(count, count / (size() * 4) + 1, std::forward<Function>(function));
+		}
+
+	private:
+		void wake()
+		{
+			if (m_sleepers.load() == 0)
+			{
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock{ m_sleep };
+			}
+			m_wake.notify_all();
+		}
+
+		size_t ownQueue() const
+		{
+			return t_system.get() == this ? t_queue : 0;
+		}
+
+		bool runOne(size_t own)
+		{
+			Job job;
+			if (!pop(own, job))
+			{
+				return false;
+			}
+			job();
+			return true;
+		}
+
+		bool pop(size_t own, Job& job)
+		{
+			if (m_queued.load(std::memory_order_acquire) == 0)
+			{
+				return false;
+			}
+
+			{
+				WorkQueue& queue{ *m_queues[own] };
+				std::lock_guard<std::mutex> lock{ queue.mutex };
+				if (!queue.jobs.empty())
+				{
+					job = std::move(queue.jobs.back());
+					queue.jobs.pop_back();
+					m_queued.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+
+			for (size_t offset{ 1 }; offset < m_queues.size(); ++offset)
+			{
+				WorkQueue& victim{ *m_queues[(own + offset) % m_queues.size()] };
+				std::lock_guard<std::mutex> lock{ victim.mutex };
+				if (!victim.jobs.empty())
+				{
+					job = std::move(victim.jobs.front());
+					victim.jobs.pop_front();
+					m_queued.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void work(size_t queue)
+		{
+			t_system = this;
+			t_queue = queue;
+			while (true)
+			{
+				if (runOne(queue))
+				{
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock{ m_sleep };
+				++m_sleepers;
+				m_wake.wait(lock, [this]() { return !m_running || m_queued.load() != 0; });
+				--m_sleepers;
+				if (!m_running)
+				{
+					return;
+				}
+			}
+		}
+	};
+}
+
+#endif
\ No newline at end of file
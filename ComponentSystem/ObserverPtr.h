@@ -26,27 +26,13 @@ namespace CECS
 		{
 		}
 
-		ObserverPtr(const ObserverPtr& ptr)
-			:m_ptr{ ptr.m_ptr }
-		{
-		}
+		ObserverPtr(const ObserverPtr& ptr) = default;
 
-		ObserverPtr(ObserverPtr&& ptr) noexcept
-			:m_ptr{ ptr.m_ptr }
-		{
-		}
+		ObserverPtr(ObserverPtr&& ptr) noexcept = default;
 
-		ObserverPtr& operator=(const ObserverPtr& ptr)
-		{
-			m_ptr = ptr.m_ptr;
-			return *this;
-		}
+		ObserverPtr& operator=(const ObserverPtr& ptr) = default;
 
-		ObserverPtr& operator=(ObserverPtr&& ptr) noexcept
-		{
-			m_ptr = ptr.m_ptr;
-			return *this;
-		}
+		ObserverPtr& operator=(ObserverPtr&& ptr) noexcept = default;
 
 		ObserverPtr& operator=(T* ptr)
 		{
@@ -64,11 +50,21 @@ namespace CECS
 			return m_ptr;
 		}
 
+		const T* get() const
+		{
+			return m_ptr;
+		}
+
 		T* operator->()
 		{
 			return m_ptr;
 		}
 
+		const T* operator->() const
+		{
+			return m_ptr;
+		}
+
 		const T& operator*() const
 		{
 			return *m_ptr;
@@ -86,12 +82,12 @@ namespace CECS
 
 		bool operator==(const ObserverPtr<T>& observePtr) const
 		{
-			return m_ptr == observePtr;
+			return m_ptr == observePtr.m_ptr;
 		}
 
 		bool operator!=(const ObserverPtr<T>& observePtr) const
 		{
-			return m_ptr != observePtr;
+			return m_ptr != observePtr.m_ptr;
 		}
 	};
 
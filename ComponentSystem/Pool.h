@@ -1,117 +1,532 @@
 #ifndef POOL_H
 #define POOL_H
 
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
 #include "Core.h"
 
 #include "ClusterContainer.h"
 #include "EntityContainer.h"
+#include "EntityRange.h"
 #include "ClusterTraits.h"
 #include "Indexer.h"
+#include "ChunkArena.h"
+#include "SharedMutex.h"
 
 namespace CECS
 {
+	// Concurrency: m_structure guards the cluster graph, the register and the entity table,
+	// and each cluster's mutex guards its rows. Lookups, getComponent, setComponent and
+	// readComponent hold both shared, so concurrent reads and in-place writes of distinct
+	// components are safe. Moving or destroying a single entity holds m_structure shared and
+	// only the source and destination clusters exclusively; anything that creates entities,
+	// clusters, edges or registrations, or touches whole clusters, takes m_structure exclusively.
+	// References from getComponent and views stay valid only until that cluster changes structure.
+	// Structure locks nest per thread and pool, but a shared hold cannot be upgraded to an exclusive one.
+	// A thread may hold the locks of up to MAX_LOCKED_POOLS pools at once.
 	class Pool
 	{
 	private:
+		ChunkArena m_arena;
 		ComponentRegister m_register;
-		ClusterContainer m_clusters;
-		EntityContainer m_entites;
-		Indexer<EntityID> m_indexer{1};
+		ClusterContainer m_clusters{ m_arena };
+		EntityContainer m_entites{ m_arena };
+		Indexer<EntityID> m_indexer{ 1, m_arena };
+		mutable SharedMutex m_structure;
+		SharedMutex m_released;
+
+		struct LockState
+		{
+			const Pool* pool;
+			bool exclusive;
+		};
+
+		static constexpr size_t MAX_LOCKED_POOLS{ 8 };
+
+		static inline thread_local std::array<LockState, MAX_LOCKED_POOLS> t_locked{};
+		static inline thread_local size_t t_lockedCount{};
 
 		friend class Accessor;
+		friend class CommandBuffer;
 
 	public:
+		class StructureLock
+		{
+		private:
+			const Pool* m_pool;
+			bool m_exclusive{};
+			bool m_owner{};
+
+		public:
+			StructureLock(const Pool& pool, bool exclusive)
+				:m_pool{ &pool }, m_exclusive{ exclusive }
+			{
+				for (size_t index{}; index < t_lockedCount; ++index)
+				{
+					if (t_locked[index].pool == &pool)
+					{
+						if (m_exclusive && !t_locked[index].exclusive)
+						{
+							throw std::logic_error{ "structure lock cannot be upgraded from shared to exclusive" };
+						}
+						return;
+					}
+				}
+				if (t_lockedCount == MAX_LOCKED_POOLS)
+				{
+					throw std::length_error{ "too many pools are structure locked by one thread" };
+				}
+				if (m_exclusive)
+				{
+					pool.m_structure.lock();
+				}
+				else
+				{
+					pool.m_structure.lock_shared();
+				}
+				t_locked[t_lockedCount++] = LockState{ &pool, m_exclusive };
+				m_owner = true;
+			}
+
+			StructureLock(const StructureLock& lock) = delete;
+
+			StructureLock& operator=(const StructureLock& lock) = delete;
+
+			~StructureLock()
+			{
+				if (!m_owner)
+				{
+					return;
+				}
+				for (size_t index{}; index < t_lockedCount; ++index)
+				{
+					if (t_locked[index].pool == m_pool)
+					{
+						t_locked[index] = t_locked[--t_lockedCount];
+						break;
+					}
+				}
+				if (m_exclusive)
+				{
+					m_pool->m_structure.unlock();
+				}
+				else
+				{
+					m_pool->m_structure.unlock_shared();
+				}
+			}
+		};
+
 		Pool() = default;
 
 		~Pool() = default;
 
 		EntityID createEntity()
 		{
-			EntityID out{ m_indexer.createIndex() };
-			m_entites.addEntity(out);
+			StructureLock lock{ *this, true };
+			return m_entites.addEntity(m_indexer.createIndex());
+		}
+
+		bool isAlive(EntityID id) const
+		{
+			StructureLock lock{ *this, false };
+			return m_entites.isAlive(id);
+		}
+
+		template<typename... Args>
+		EntityRange spawn(size_t count, const Args&... components)
+		{
+			StructureLock lock{ *this, true };
+			if (count == 0)
+			{
+				return EntityRange{};
+			}
+
+			EntityRange out{ m_indexer.createIndices(count), count };
+			if constexpr (sizeof...(Args) == 0)
+			{
+				m_entites.addEntities(out.front(), count, nullptr, 0);
+				return out;
+			}
+
+			Cluster& cluster{ *m_clusters.getCluster(createSignature<Args...>(), m_register) };
+			Index row{ cluster.addEntities(out.front(), count) };
+			m_entites.addEntities(out.front(), count, &cluster, row);
+			(cluster.fillComponent<Args>(components, count, m_register.getID<Args>()), ...);
+			return out;
+		}
+
+		template<typename... Args, typename Generator>
+			requires std::invocable<Generator&, EntityID, Args&...>
+		EntityRange spawn(size_t count, Generator&& generator)
+		{
+			StructureLock lock{ *this, true };
+			EntityRange out{ spawn<Args...>(count, Args{}...) };
+			if (out.empty())
+			{
+				return out;
+			}
+			if constexpr (sizeof...(Args) == 0)
+			{
+				for (EntityID id : out)
+				{
+					generator(id);
+				}
+				return out;
+			}
+
+			EntityLocation& location{ m_entites.getLocation(out.front()) };
+			Cluster::Cache<Args...> cache{ *location.cluster, registerComponents<Args...>() };
+			auto fill{ [&generator](const EntityID* ids, Args*... components, size_t size)
+				{
+					for (size_t index{}; index < size; ++index)
+					{
+						generator(ids[index], components[index]...);
+					}
+				} };
+			for (Index row{ location.row }; row < location.row + count;)
+			{
+				size_t run{ std::min<size_t>(cache.contiguous(row), location.row + count - row) };
+				cache.invoke(fill, row, run);
+				row += static_cast<Index>(run);
+			}
 			return out;
 		}
 
 		void destroyEntity(EntityID id)
 		{
-			if (id == nullent)
+			if (releaseEntity(id))
+			{
+				return;
+			}
+
+			StructureLock lock{ *this, true };
+			if (!isAlive(id))
 			{
 				return;
 			}
 			ObserverPtr<Cluster> cluster{ m_entites.getEntityCluster(id) };
-			m_entites.removeEntity(id);
 			m_indexer.releaseIndex(id);
 
-			if (cluster.isValid())
+			if (!cluster.isValid())
 			{
-				cluster->removeEntity(id);
+				m_entites.removeEntity(id);
+				return;
 			}
+			ClusterTraits::removeEntity(id, m_entites);
+			checkCluster(*cluster);
+		}
+
+		void destroyEntities(const std::vector<EntityID>& ids)
+		{
+			StructureLock lock{ *this, true };
+			std::vector<EntityID> unique{ ids };
+			std::sort(unique.begin(), unique.end());
+			unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+			std::unordered_map<ClusterID, std::vector<size_t>, Hash<ClusterID>> removals;
+			for (EntityID id : unique)
+			{
+				if (!isAlive(id))
+				{
+					continue;
+				}
+				EntityLocation location{ m_entites.getLocation(id) };
+				m_entites.removeEntity(id);
+				m_indexer.releaseIndex(id);
+
+				if (location.cluster.isValid())
+				{
+					removals[location.cluster->getID()].push_back(location.row);
+				}
+			}
+
+			for (auto& pair : removals)
+			{
+				ObserverPtr<Cluster> cluster{ m_clusters.getCluster(pair.first) };
+				ClusterTraits::removeEntities(*cluster, pair.second, m_entites);
+				checkCluster(*cluster);
+			}
+		}
+
+		void destroyEntities(ObserverPtr<Query> query)
+		{
+			StructureLock lock{ *this, true };
+			std::vector<ObserverPtr<Cluster>> clusters{ query->getClusters() };
+			for (ObserverPtr<Cluster>& cluster : clusters)
+			{
+				dropCluster(*cluster);
+			}
+		}
+
+		template<typename T>
+		void addComponent(EntityID id, T&& component)
+		{
+			addComponent<T>(id, std::move(component), acquireComponent<T>());
 		}
 
 		template<typename T>
 		void addComponent(EntityID id, T&& component, const TypeName& name)
 		{
-			m_register.registerComponent<T>(name);
+			ComponentID componentID{};
+			{
+				StructureLock lock{ *this, true };
+				componentID = m_register.registerComponent<T>(name);
+			}
+			addComponent<T>(id, std::move(component), componentID);
+		}
 
-			ObserverPtr<Cluster>& oldCluster{ m_entites.getEntityCluster(id) };
+		template<typename T>
+		void addComponent(EntityID id, T&& component, ComponentID componentID)
+		{
+			auto add{ [&component](ClusterEdge& edge)
+				{
+					static_cast<ComponentArray<T>&>(*edge.added).addComponent(std::move(component));
+				} };
+			if (moveEntity(id, componentID, true, add))
+			{
+				return;
+			}
 
-			Signature signature;
-			if (oldCluster.isValid())
+			StructureLock lock{ *this, true };
+			if (!isAlive(id))
 			{
-				signature = oldCluster->getSignature();
+				return;
+			}
+			EntityLocation& location{ m_entites.getLocation(id) };
+			if (!location.cluster.isValid())
+			{
+				Signature signature;
+				signature.set(componentID);
+				ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
+				location = EntityLocation{ newCluster, newCluster->addEntity(id) };
+				newCluster->addComponent(std::move(component), id, componentID);
+				return;
 			}
-			signature.set(m_register.getID(name));
-			ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
 
-			if(oldCluster.isValid())
+			if (location.cluster->getSignature().check(componentID))
 			{
-				ClusterTraits::carryEntity(id, id, *oldCluster, *newCluster);
-				checkCluster(*oldCluster);
+				location.cluster->setComponent<T>(std::move(component), location.row, componentID);
+				return;
 			}
-			else
+
+			Cluster& current{ *location.cluster };
+			ClusterEdge& edge{ m_clusters.getEdge(current, componentID, true, m_register) };
+			ClusterTraits::carryEntity(id, m_entites, edge);
+			static_cast<ComponentArray<T>&>(*edge.added).addComponent(std::move(component));
+			checkCluster(current);
+		}
+
+		template<typename T>
+		void addComponent(ObserverPtr<Query> query, const T& component)
+		{
+			StructureLock lock{ *this, true };
+			ComponentID componentID{ m_register.registerComponent<T>() };
+			std::vector<ObserverPtr<Cluster>> clusters{ query->getClusters() };
+			for (ObserverPtr<Cluster>& cluster : clusters)
+			{
+				if (cluster->getSignature().check(componentID))
+				{
+					for (Index row{}; row < cluster->size(); ++row)
+					{
+						cluster->setComponent<T>(component, row, componentID);
+					}
+					continue;
+				}
+
+				Cluster& destination{ *m_clusters.getEdge(*cluster, componentID, true, m_register).destination };
+				size_t count{ cluster->size() };
+				ClusterTraits::carryEntities(*cluster, destination, m_entites);
+				destination.fillComponent<T>(component, count, componentID);
+				checkCluster(*cluster);
+			}
+		}
+
+		template<typename T>
+		void removeComponent(EntityID id)
+		{
+			ComponentID componentID{ findComponent<T>() };
+			if (componentID != nullcomponent)
 			{
-				newCluster->addEntity(id);
+				removeComponent(id, componentID);
 			}
-			oldCluster = newCluster;
-			newCluster->addComponent(std::move(component), id, name);
 		}
 
 		void removeComponent(EntityID id, const TypeName& name)
 		{
-			ObserverPtr<Cluster>& oldCluster{ m_entites.getEntityCluster(id) };
-			Signature signature{ oldCluster->getSignature() };
-			signature.set(m_register.getID(name),false);
+			ComponentID componentID{ findComponent(name) };
+			if (componentID != nullcomponent)
+			{
+				removeComponent(id, componentID);
+			}
+		}
+
+		void removeComponent(EntityID id, ComponentID componentID)
+		{
+			if (moveEntity(id, componentID, false, [](ClusterEdge&) {}))
+			{
+				return;
+			}
 
-			if (!signature.any())
+			StructureLock lock{ *this, true };
+			if (!isAlive(id))
+			{
+				return;
+			}
+			ObserverPtr<Cluster> oldCluster{ m_entites.getEntityCluster(id) };
+			if (!oldCluster.isValid() || !oldCluster->getSignature().check(componentID))
+			{
+				return;
+			}
+
+			Cluster& current{ *oldCluster };
+			ClusterEdge& edge{ m_clusters.getEdge(current, componentID, false, m_register) };
+			if (!edge.destination.isValid())
 			{
 				destroyEntity(id);
+				return;
 			}
-			else 
+
+			ClusterTraits::carryEntity(id, m_entites, edge);
+			checkCluster(current);
+		}
+
+		template<typename T>
+		void removeComponent(ObserverPtr<Query> query)
+		{
+			ComponentID componentID{ findComponent<T>() };
+			if (componentID != nullcomponent)
 			{
-				ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
-				ClusterTraits::carryEntity(id, id, *oldCluster, *newCluster);
-				checkCluster(*oldCluster);
-				oldCluster = newCluster;
+				removeComponent(query, componentID);
+			}
+		}
+
+		void removeComponent(ObserverPtr<Query> query, ComponentID componentID)
+		{
+			StructureLock lock{ *this, true };
+			std::vector<ObserverPtr<Cluster>> clusters{ query->getClusters() };
+			for (ObserverPtr<Cluster>& cluster : clusters)
+			{
+				if (!cluster->getSignature().check(componentID))
+				{
+					continue;
+				}
+
+				ClusterEdge& edge{ m_clusters.getEdge(*cluster, componentID, false, m_register) };
+				if (!edge.destination.isValid())
+				{
+					dropCluster(*cluster);
+					continue;
+				}
+				ClusterTraits::carryEntities(*cluster, *edge.destination, m_entites);
+				checkCluster(*cluster);
 			}
 		}
 
+		template<typename T>
+		T& getComponent(EntityID id)
+		{
+			StructureLock lock{ *this, false };
+			return getComponent<T>(id, m_register.getID<T>());
+		}
+
 		template<typename T>
 		T& getComponent(EntityID id, const TypeName& name)
 		{
-			return getCluster(id).getComponent<T>(id, name);
+			StructureLock lock{ *this, false };
+			return getComponent<T>(id, m_register.getID(name));
+		}
+
+		template<typename T>
+		T& getComponent(EntityID id, ComponentID component)
+		{
+			T* out{};
+			if (!visitEntity(id, [&out, component](Cluster& cluster, Index row)
+				{
+					out = &cluster.getComponent<T>(row, component);
+				}))
+			{
+				throw std::out_of_range{ "entity is not alive or has no components" };
+			}
+			return *out;
+		}
+
+		template<typename T>
+		T readComponent(EntityID id)
+		{
+			StructureLock lock{ *this, false };
+			return readComponent<T>(id, m_register.getID<T>());
+		}
+
+		template<typename T>
+		T readComponent(EntityID id, ComponentID component)
+		{
+			std::optional<T> out;
+			if (!visitEntity(id, [&out, component](Cluster& cluster, Index row)
+				{
+					out.emplace(cluster.getComponent<T>(row, component));
+				}))
+			{
+				throw std::out_of_range{ "entity is not alive or has no components" };
+			}
+			return std::move(*out);
+		}
+
+		template<typename T>
+		void setComponent(EntityID id, T&& component)
+		{
+			StructureLock lock{ *this, false };
+			setComponent<T>(id, std::move(component), m_register.getID<T>());
 		}
 
 		template<typename T>
 		void setComponent(EntityID id, T&& component, const TypeName& name)
 		{
-			getCluster(id).setComponent<T>(std::move(component), id, name);
+			StructureLock lock{ *this, false };
+			setComponent<T>(id, std::move(component), m_register.getID(name));
+		}
+
+		template<typename T>
+		void setComponent(EntityID id, T&& item, ComponentID component)
+		{
+			visitEntity(id, [&item, component](Cluster& cluster, Index row)
+				{
+					cluster.setComponent<T>(std::move(item), row, component);
+				});
 		}
 
 		template<typename... Args>
 		void addComponents(EntityID id, Args&&... components, const std::vector<TypeName>& names)
 		{
-			Signature addition{ createSignature<Args...>(names) };
-			ObserverPtr<Cluster>& oldCluster{ m_entites.getEntityCluster(id) };
+			StructureLock lock{ *this, true };
+			std::vector<ComponentID> componentIDs;
+			Index index{ 0 };
+			((componentIDs.push_back(m_register.registerComponent<Args>(names[index])), ++index), ...);
+			addComponents<Args...>(id, std::move(components)..., componentIDs);
+		}
+
+		template<typename... Args>
+		void addComponents(EntityID id, Args&&... components, const std::vector<ComponentID>& componentIDs)
+		{
+			StructureLock lock{ *this, true };
+			if (!isAlive(id))
+			{
+				return;
+			}
+			Signature addition;
+			for (ComponentID componentID : componentIDs)
+			{
+				addition.set(componentID);
+			}
+			ObserverPtr<Cluster> oldCluster{ m_entites.getEntityCluster(id) };
 
 			Signature signature;
 			if (oldCluster.isValid())
@@ -123,65 +538,285 @@ namespace CECS
 			ObserverPtr<Cluster> newCluster{ m_clusters.getCluster(signature,m_register) };
 			if (oldCluster.isValid())
 			{
-				ClusterTraits::carryEntity(id, id, *oldCluster, *newCluster);
+				ClusterTraits::carryEntity(id, m_entites, *newCluster);
 				checkCluster(*oldCluster);
 			}
 			else
 			{
-				newCluster->addEntity(id);
+				m_entites.setCluster(id, newCluster, newCluster->addEntity(id));
 			}
-			oldCluster = newCluster;
-			newCluster->addComponents<Args...>(std::move(components)..., id, names);
+			newCluster->addComponents<Args...>(std::move(components)..., id, componentIDs);
+		}
+
+		template <typename... Args>
+		std::vector<ComponentID> registerComponents()
+		{
+			StructureLock lock{ *this, true };
+			return { m_register.registerComponent<Args>()... };
+		}
+
+		template <typename... Args>
+		Signature createSignature()
+		{
+			StructureLock lock{ *this, true };
+			Signature out;
+			(out.set(m_register.registerComponent<Args>()), ...);
+			return out;
 		}
 
 		template <typename... Args>
 		Signature createSignature(const std::vector<TypeName>& names)
 		{
+			StructureLock lock{ *this, true };
 			Signature out;
 			Index index{ 0 };
-			((m_register.registerComponent<Args>(names[index]),out.set(m_register.getID(names[index])), ++index), ...);
+			((out.set(m_register.registerComponent<Args>(names[index])), ++index), ...);
 			return out;
 		}
 
 		Cluster& getCluster(EntityID id)
 		{
-			return *m_clusters.getCluster(m_entites.getClusterID(id));
+			StructureLock lock{ *this, false };
+			return *m_entites.loadCluster(id);
 		}
 
 		void copyEntity(EntityID newEntity, EntityID oldEntity)
 		{
-			ObserverPtr<Cluster>& currentCluster{ m_entites.getEntityCluster(newEntity) };
-			ObserverPtr<Cluster> destinationCluster{ m_entites.getEntityCluster(oldEntity) };
+			StructureLock lock{ *this, true };
+			if (newEntity == oldEntity || !isAlive(newEntity) || !isAlive(oldEntity))
+			{
+				return;
+			}
+			ObserverPtr<Cluster> currentCluster{ m_entites.getEntityCluster(newEntity) };
+			ObserverPtr<Cluster> originCluster{ m_entites.getEntityCluster(oldEntity) };
 
 			if (currentCluster.isValid())
 			{
-				currentCluster->removeEntity(newEntity);
+				ClusterTraits::releaseEntity(newEntity, m_entites);
+			}
+			if (originCluster.isValid())
+			{
+				ClusterTraits::copyEntity(newEntity, oldEntity, *originCluster, *originCluster, m_entites);
 			}
-			if (destinationCluster.isValid())
+			if (currentCluster.isValid() && currentCluster != originCluster)
 			{
-				ClusterTraits::copyEntity(newEntity, oldEntity, *currentCluster, *destinationCluster);
+				checkCluster(*currentCluster);
 			}
-			currentCluster = destinationCluster;
+		}
+
+		EntityRange instantiate(EntityID prefab, size_t count)
+		{
+			StructureLock lock{ *this, true };
+			if (count == 0 || !isAlive(prefab))
+			{
+				return EntityRange{};
+			}
+
+			EntityRange out{ m_indexer.createIndices(count), count };
+			EntityLocation location{ m_entites.getLocation(prefab) };
+			if (!location.cluster.isValid())
+			{
+				m_entites.addEntities(out.front(), count, nullptr, 0);
+				return out;
+			}
+
+			Index row{ location.cluster->addEntities(out.front(), count) };
+			m_entites.addEntities(out.front(), count, location.cluster, row);
+			location.cluster->replicate(location.row, count);
+			return out;
 		}
 
 		void carryEntity(EntityID id, ClusterID newCluster)
 		{
-			ObserverPtr<Cluster>& oldCluster{ m_entites.getEntityCluster(id) };
+			StructureLock lock{ *this, true };
+			ObserverPtr<Cluster> oldCluster{ m_entites.getEntityCluster(id) };
 			ObserverPtr<Cluster> destination{ m_clusters.getCluster(newCluster) };
-			ClusterTraits::carryEntity(id, id, *oldCluster, *destination);
+			ClusterTraits::carryEntity(id, m_entites, *destination);
 			checkCluster(*oldCluster);
-			oldCluster = destination;
+		}
+
+		template<typename T>
+		bool hasComponent(EntityID id)
+		{
+			StructureLock lock{ *this, false };
+			return hasComponent(id, m_register.getID<T>());
 		}
 
 		bool hasComponent(EntityID id, const TypeName& name)
 		{
-			return getCluster(id).getSignature().check(m_register.getID(name));
+			StructureLock lock{ *this, false };
+			return m_register.registered(name) && hasComponent(id, m_register.getID(name));
+		}
+
+		bool hasComponent(EntityID id, ComponentID component)
+		{
+			StructureLock lock{ *this, false };
+			if (!isAlive(id))
+			{
+				return false;
+			}
+			ObserverPtr<Cluster> cluster{ m_entites.loadCluster(id) };
+			return cluster.isValid() && cluster->getSignature().check(component);
+		}
+
+		void removeEmptyClusters()
+		{
+			StructureLock lock{ *this, true };
+			m_clusters.removeEmptyClusters();
+		}
+
+		template<typename... Args>
+		ObserverPtr<Query> createQuery(const Signature& excluded = Signature{})
+		{
+			StructureLock lock{ *this, true };
+			return m_clusters.createQuery(registerComponents<Args...>(), excluded);
+		}
+
+		ObserverPtr<Query> createQuery(const std::vector<ComponentID>& components, const Signature& excluded = Signature{})
+		{
+			StructureLock lock{ *this, true };
+			return m_clusters.createQuery(components, excluded);
+		}
+
+		void destroyQuery(ObserverPtr<Query> query)
+		{
+			StructureLock lock{ *this, true };
+			m_clusters.destroyQuery(query);
+		}
+
+		ChunkArena& getArena()
+		{
+			return m_arena;
+		}
+
+		ArenaStatistics getArenaStatistics() const
+		{
+			return m_arena.getStatistics();
 		}
 
 	private:
+		template<typename T>
+		ComponentID findComponent() const
+		{
+			StructureLock lock{ *this, false };
+			return m_register.getID<T>();
+		}
+
+		ComponentID findComponent(const TypeName& name) const
+		{
+			StructureLock lock{ *this, false };
+			return m_register.registered(name) ? m_register.getID(name) : nullcomponent;
+		}
+
+		template<typename T>
+		ComponentID acquireComponent()
+		{
+			ComponentID out{ findComponent<T>() };
+			if (out != nullcomponent)
+			{
+				return out;
+			}
+			StructureLock lock{ *this, true };
+			return m_register.registerComponent<T>();
+		}
+
+		template<typename Function>
+		bool visitEntity(EntityID id, Function&& function)
+		{
+			StructureLock lock{ *this, false };
+			while (m_entites.isAlive(id))
+			{
+				ObserverPtr<Cluster> cluster{ m_entites.loadCluster(id) };
+				if (!cluster.isValid())
+				{
+					return false;
+				}
+
+				std::shared_lock<SharedMutex> rows{ cluster->getMutex() };
+				if (m_entites.loadCluster(id) == cluster)
+				{
+					function(*cluster, m_entites.getLocation(id).row);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		template<typename Function>
+		bool moveEntity(EntityID id, ComponentID component, bool add, Function&& function)
+		{
+			StructureLock lock{ *this, false };
+			while (m_entites.isAlive(id))
+			{
+				ObserverPtr<Cluster> current{ m_entites.loadCluster(id) };
+				if (!current.isValid() || current->getSignature().check(component) == add)
+				{
+					return false;
+				}
+				ObserverPtr<ClusterEdge> edge{ current->getEdge(component, add) };
+				if (!edge.isValid() || !edge->destination.isValid())
+				{
+					return false;
+				}
+
+				std::scoped_lock<SharedMutex, SharedMutex> rows{ current->getMutex(), edge->destination->getMutex() };
+				if (m_entites.loadCluster(id) != current)
+				{
+					continue;
+				}
+				if (current->size() == 1 && !current->linked())
+				{
+					return false;
+				}
+				ClusterTraits::carryEntity(id, m_entites, *edge);
+				function(*edge);
+				return true;
+			}
+			return true;
+		}
+
+		bool releaseEntity(EntityID id)
+		{
+			StructureLock lock{ *this, false };
+			while (m_entites.isAlive(id))
+			{
+				ObserverPtr<Cluster> cluster{ m_entites.loadCluster(id) };
+				if (!cluster.isValid())
+				{
+					return false;
+				}
+
+				std::unique_lock<SharedMutex> rows{ cluster->getMutex() };
+				if (m_entites.loadCluster(id) != cluster)
+				{
+					continue;
+				}
+				if (cluster->size() == 1 && !cluster->linked())
+				{
+					return false;
+				}
+				ClusterTraits::removeEntity(id, m_entites);
+				std::lock_guard<SharedMutex> released{ m_released };
+				m_indexer.releaseIndex(id);
+				return true;
+			}
+			return true;
+		}
+
+		void dropCluster(Cluster& cluster)
+		{
+			for (Index row{}; row < cluster.size(); ++row)
+			{
+				m_entites.removeEntity(cluster.getEntity(row));
+			}
+			m_indexer.releaseIndices(cluster.getEntities());
+			cluster.clear();
+			checkCluster(cluster);
+		}
+
 		void checkCluster(Cluster& cluster)
 		{
-			if (cluster.empty())
+			if (cluster.empty() && !cluster.linked())
 			{
 				m_clusters.removeCluster(cluster);
 			}
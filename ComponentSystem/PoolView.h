@@ -1,6 +1,7 @@
 #ifndef POOLVIEW_H
 #define	POOLVIEW_H
 
+#include <algorithm>
 #include <vector>
 #include <tuple>
 
@@ -8,37 +9,44 @@
 
 #include "Accessor.h"
 #include "Cluster.h"
+#include "JobSystem.h"
 #include "ObserverPtr.h"
 #include "Signature.h"
+#include "Query.h"
 
 namespace CECS
 {
+	inline constexpr size_t MIN_BATCH_ROWS{ 1024 };
+
 	template<typename... Args>
 	class PoolView
 	{
 	private:
-		template<typename... Args>
+		struct RowRange
+		{
+			ObserverPtr<Cluster> cluster;
+			Index first;
+			Index count;
+		};
+
 		class PoolIterator
 		{
 		private:
 			ClusterContainer::ClusterWindow& m_clusters;
-			std::vector<TypeName>& m_typeNames;
-			Index m_clusterIndex;
-			Index m_itemIndex;
+			std::vector<ComponentID>& m_components;
+			size_t m_clusterIndex;
+			size_t m_itemIndex;
 			Cluster::Cache<Args...> m_cache;
 
 		public:
 			PoolIterator(
 				ClusterContainer::ClusterWindow& clusters, 
-				std::vector<TypeName>& typeNames, 
-				Index clusterIndex, 
-				Index itemIndex)
-				:m_clusters{ clusters }, m_typeNames{typeNames}, m_clusterIndex{ clusterIndex }, m_itemIndex{ itemIndex }
+				std::vector<ComponentID>& components, 
+				size_t clusterIndex, 
+				size_t itemIndex)
+				:m_clusters{ clusters }, m_components{components}, m_clusterIndex{ clusterIndex }, m_itemIndex{ itemIndex }
 			{
-				if (m_clusterIndex < m_clusters.size())
-				{
-					m_cache = Cluster::Cache<Args...>(*m_clusters[m_clusterIndex],m_typeNames);
-				}
+				seek();
 			}
 
 			PoolIterator& operator++()
@@ -48,10 +56,7 @@ namespace CECS
 				{
 					m_itemIndex = 0;
 					m_clusterIndex++;
-					if (m_clusterIndex < m_clusters.size())
-					{
-						m_cache = Cluster::Cache<Args...>(*m_clusters[m_clusterIndex],m_typeNames);
-					}
+					seek();
 				}
 				return *this;
 			}
@@ -68,47 +73,172 @@ namespace CECS
 
 			std::tuple<EntityID, Args&...> operator*()
 			{
-				return m_cache.getItems(m_itemIndex);
+				return m_cache.getItems(static_cast<Index>(m_itemIndex));
+			}
+
+		private:
+			void seek()
+			{
+				while (m_clusterIndex < m_clusters.size() && m_clusters[m_clusterIndex]->empty())
+				{
+					++m_clusterIndex;
+				}
+				if (m_clusterIndex < m_clusters.size())
+				{
+					m_cache = Cluster::Cache<Args...>(*m_clusters[m_clusterIndex],m_components);
+				}
 			}
 		};
 
 		ClusterContainer::ClusterWindow m_clusters;
-		std::vector<TypeName> m_typeNames;
+		std::vector<ComponentID> m_components;
+		ObserverPtr<Query> m_query;
 
 	public:
 		PoolView()
 		{
-			(m_typeNames.push_back(typeid(Args).name()),...);
-			setup(Signature{});
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			ComponentRegister& components{ Accessor::getComponentRegister() };
+			setup(std::vector<ComponentID>{ components.registerComponent<Args>()... }, Signature{});
 		}
 
 		PoolView(const std::vector<TypeName>& needed)
 		{
-			m_typeNames = needed;
-			setup(Signature{});
+			setup(needed, Signature{});
 		}
 
 		PoolView(const std::vector<TypeName>& needed, const std::vector<TypeName>& noNeeded)
 		{
-			m_typeNames = needed;
-			setup(Accessor::createSignature(noNeeded));
+			setup(needed, Accessor::createSignature(noNeeded));
+		}
+
+		PoolView(ObserverPtr<Query> query)
+			:m_query{ query }
+		{
+		}
+
+		PoolIterator begin()
+		{
+			return PoolIterator(getClusters(), getComponents(), 0, 0);
+		}
+
+		PoolIterator end()
+		{
+			return PoolIterator(getClusters(), getComponents(), getClusters().size(), 0);
+		}
+
+		template<typename Function>
+		void eachChunk(Function&& function)
+		{
+			for (ObserverPtr<Cluster>& cluster : getClusters())
+			{
+				Cluster::Cache<Args...> cache{ *cluster, getComponents() };
+				Index size{ static_cast<Index>(cluster->size()) };
+				for (Index index{}; index < size;)
+				{
+					size_t count{ cache.contiguous(index) };
+					cache.invoke(function, index, count);
+					index += static_cast<Index>(count);
+				}
+			}
 		}
 
-		PoolIterator<Args...> begin()
+		template<typename Function>
+		void parallelEach(Function&& function, JobSystem& jobs = JobSystem::instance())
 		{
-			return PoolIterator<Args...>(m_clusters, m_typeNames, 0, 0);
+			std::vector<RowRange> ranges;
+			std::vector<size_t> batches{ 0 };
+			size_t grain{ std::max(MIN_BATCH_ROWS, size() / (jobs.size() * 4) + 1) };
+			size_t batched{};
+			for (ObserverPtr<Cluster>& cluster : getClusters())
+			{
+				Cluster::Cache<Args...> cache{ *cluster, getComponents() };
+				Index size{ static_cast<Index>(cluster->size()) };
+				for (Index index{}; index < size;)
+				{
+					Index count{ static_cast<Index>(std::min(cache.contiguous(index), grain - batched)) };
+					ranges.push_back(RowRange{ cluster, index, count });
+					index += count;
+					batched += count;
+					if (batched == grain)
+					{
+						batches.push_back(ranges.size());
+						batched = 0;
+					}
+				}
+			}
+			if (batches.back() != ranges.size())
+			{
+				batches.push_back(ranges.size());
+			}
+
+			auto each{ [&function](const EntityID* ids, Args*... components, size_t count)
+				{
+					for (size_t index{}; index < count; ++index)
+					{
+						function(ids[index], components[index]...);
+					}
+				} };
+			jobs.dispatch(batches.size() - 1, [&](size_t batch)
+				{
+					for (size_t range{ batches[batch] }; range < batches[batch + 1]; ++range)
+					{
+						Cluster::Cache<Args...> cache{ *ranges[range].cluster, getComponents() };
+						cache.invoke(each, ranges[range].first, ranges[range].count);
+					}
+				});
 		}
 
-		PoolIterator<Args...> end()
+		size_t size()
 		{
-			return PoolIterator<Args...>(m_clusters, m_typeNames, static_cast<Index>(m_clusters.size()), 0);
+			if (m_query.isValid())
+			{
+				return m_query->size();
+			}
+
+			size_t out{};
+			for (ObserverPtr<Cluster>& cluster : m_clusters)
+			{
+				out += cluster->size();
+			}
+			return out;
 		}
 
 	private:
-		void setup(const Signature& noIntersection)
+		ClusterContainer::ClusterWindow& getClusters()
+		{
+			return m_query.isValid() ? m_query->getClusters() : m_clusters;
+		}
+
+		std::vector<ComponentID>& getComponents()
+		{
+			return m_query.isValid() ? m_query->getComponents() : m_components;
+		}
+
+		void setup(const std::vector<TypeName>& needed, const Signature& noIntersection)
 		{
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			ComponentRegister& components{ Accessor::getComponentRegister() };
+			std::vector<ComponentID> componentIDs;
+			for (const TypeName& name : needed)
+			{
+				componentIDs.push_back(components.getID(name));
+			}
+			setup(componentIDs, noIntersection);
+		}
+
+		void setup(const std::vector<ComponentID>& needed, const Signature& noIntersection)
+		{
+			Pool::StructureLock lock{ *Accessor::getPool(), true };
+			m_components = needed;
+			Signature subset;
+			for (ComponentID component : needed)
+			{
+				subset.set(component);
+			}
+
 			ClusterContainer& container{ Accessor::getClusterContainer() };
-			m_clusters = container.getClusters(Accessor::createSignature(m_typeNames), noIntersection);
+			m_clusters = container.getClusters(subset, noIntersection);
 		}
 	};
 }
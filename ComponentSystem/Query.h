@@ -0,0 +1,82 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <atomic>
+#include <vector>
+
+#include "Core.h"
+
+#include "Signature.h"
+#include "ObserverPtr.h"
+
+namespace CECS
+{
+	class Cluster;
+
+	class Query
+	{
+	public:
+		using ClusterList = std::vector<ObserverPtr<Cluster>>;
+
+	private:
+		Signature m_required;
+		Signature m_excluded;
+		std::vector<ComponentID> m_components;
+		ClusterList m_clusters;
+		std::atomic<size_t> m_entities{};
+
+		friend class Cluster;
+		friend struct ClusterTraits;
+
+	public:
+		Query(const std::vector<ComponentID>& components, const Signature& excluded)
+			:m_excluded{ excluded }, m_components{ components }
+		{
+			for (ComponentID component : m_components)
+			{
+				m_required.set(component);
+			}
+		}
+
+		Query(const Query& query) = delete;
+
+		Query& operator=(const Query& query) = delete;
+
+		bool matches(const Signature& signature) const
+		{
+			return m_required.subset(signature) && !m_excluded.anyMatch(signature);
+		}
+
+		ClusterList& getClusters()
+		{
+			return m_clusters;
+		}
+
+		std::vector<ComponentID>& getComponents()
+		{
+			return m_components;
+		}
+
+		const Signature& getRequired() const
+		{
+			return m_required;
+		}
+
+		const Signature& getExcluded() const
+		{
+			return m_excluded;
+		}
+
+		size_t size() const
+		{
+			return m_entities;
+		}
+
+		bool empty() const
+		{
+			return m_entities == 0;
+		}
+	};
+}
+
+#endif
\ No newline at end of file
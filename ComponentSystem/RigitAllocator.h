@@ -1,23 +1,74 @@
-#ifndef RIGITALLOVATOR_H
+#ifndef RIGITALLOCATOR_H
 #define RIGITALLOCATOR_H
 
+#include <algorithm>
 #include <memory>
 
+#include "ChunkArena.h"
+#include "ObserverPtr.h"
+
 namespace CECS
 {
+	inline constexpr size_t MIN_ARRAY_BYTES{ 512 };
+#ifdef CECS_HUGE_PAGES
+	inline constexpr size_t ARRAY_BYTES{ HUGE_PAGE_BYTES };
+#else
 	inline constexpr size_t ARRAY_BYTES{ 500000 };
+#endif
 
-	template<typename T>
+	template<typename T, size_t Alignment = CHUNK_ALIGNMENT>
 	class RigitAllocator: public std::allocator<T>
 	{
+	private:
+		ObserverPtr<ChunkArena> m_arena;
+
+		template<typename U, size_t OtherAlignment>
+		friend class RigitAllocator;
+
 	public:
-		size_t chunkSize()
+		static constexpr size_t ALIGNMENT{ std::max(Alignment, alignof(T)) };
+
+		template<typename U>
+		struct rebind
+		{
+			using other = RigitAllocator<U, Alignment>;
+		};
+
+		RigitAllocator() = default;
+
+		RigitAllocator(ObserverPtr<ChunkArena> arena) noexcept
+			:m_arena{ arena }
+		{
+		}
+
+		template<typename U>
+		RigitAllocator(const RigitAllocator<U, Alignment>& allocator) noexcept
+			:m_arena{ allocator.m_arena }
 		{
-			size_t size{ ARRAY_BYTES / sizeof(T) };
-			if (size == 0) {
-				return 1;
+		}
+
+		T* allocate(size_t count)
+		{
+			if (m_arena.isValid())
+			{
+				return static_cast<T*>(m_arena->allocate(count * sizeof(T), ALIGNMENT));
+			}
+			return static_cast<T*>(ChunkTraits::allocate(count * sizeof(T), ALIGNMENT));
+		}
+
+		void deallocate(T* chunk, size_t count)
+		{
+			if (m_arena.isValid())
+			{
+				m_arena->deallocate(chunk, count * sizeof(T), ALIGNMENT);
+				return;
 			}
-			return size;
+			ChunkTraits::deallocate(chunk, count * sizeof(T), ALIGNMENT);
+		}
+
+		ObserverPtr<ChunkArena> getArena() const
+		{
+			return m_arena;
 		}
 	};
 
@@ -2,6 +2,8 @@
 #define RIGITARRAY_H
 
 #include <algorithm>
+#include <bit>
+#include <cstring>
 #include <memory>
 #include <vector>
 #include <type_traits>
@@ -11,35 +13,96 @@
 namespace CECS
 {
 
+	template<typename T>
+	struct RigitLayout
+	{
+		static constexpr size_t FIRST_SIZE{ std::bit_floor(std::max<size_t>(MIN_ARRAY_BYTES / sizeof(T), 1)) };
+		static constexpr size_t MAX_SIZE{ std::max(std::bit_floor(std::max<size_t>(ARRAY_BYTES / sizeof(T), 1)), FIRST_SIZE) };
+		static constexpr size_t FIRST_SHIFT{ static_cast<size_t>(std::countr_zero(FIRST_SIZE)) };
+		static constexpr size_t MAX_SHIFT{ static_cast<size_t>(std::countr_zero(MAX_SIZE)) };
+		static constexpr size_t LEVELS{ MAX_SHIFT - FIRST_SHIFT };
+
+		static constexpr size_t chunkOf(size_t index)
+		{
+			if (index < MAX_SIZE)
+			{
+				return std::bit_width(index >> FIRST_SHIFT);
+			}
+			return LEVELS + (index >> MAX_SHIFT);
+		}
+
+		static constexpr size_t offsetOf(size_t index)
+		{
+			if (index < MAX_SIZE)
+			{
+				return index & ((FIRST_SIZE << (std::max<size_t>(chunkOf(index), 1) - 1)) - 1);
+			}
+			return index & (MAX_SIZE - 1);
+		}
+
+		static constexpr size_t chunkStart(size_t chunk)
+		{
+			if (chunk == 0)
+			{
+				return 0;
+			}
+			if (chunk <= LEVELS + 1)
+			{
+				return FIRST_SIZE << (chunk - 1);
+			}
+			return (chunk - LEVELS) << MAX_SHIFT;
+		}
+
+		static constexpr size_t chunkSize(size_t chunk)
+		{
+			if (chunk == 0)
+			{
+				return FIRST_SIZE;
+			}
+			return FIRST_SIZE << std::min(chunk - 1, LEVELS);
+		}
+	};
+
 	template<typename T>
 	class RigitIterator
 	{
 	private:
 		using MultiArray = T**;
+		using Layout = RigitLayout<std::remove_const_t<T>>;
 
 		MultiArray m_arrays;
-		size_t m_arraySize;
 		size_t m_itemIndex;
+		size_t m_chunk;
+		size_t m_chunkStart;
+		size_t m_chunkEnd;
 
 	public:
-		RigitIterator(MultiArray arrays, size_t arraySize, size_t itemIndex)
-			:m_arrays{ arrays }, m_arraySize{ arraySize }, m_itemIndex{ itemIndex }
+		RigitIterator(MultiArray arrays, size_t itemIndex)
+			:m_arrays{ arrays }, m_itemIndex{ itemIndex }, m_chunk{ Layout::chunkOf(itemIndex) }
 		{
+			m_chunkStart = Layout::chunkStart(m_chunk);
+			m_chunkEnd = Layout::chunkStart(m_chunk + 1);
 		}
 
 		T& operator*()
 		{
-			return m_arrays[m_itemIndex / m_arraySize][m_itemIndex % m_arraySize];
+			return m_arrays[m_chunk][m_itemIndex - m_chunkStart];
 		}
 
 		const T& operator*() const
 		{
-			return m_arrays[m_itemIndex / m_arraySize][m_itemIndex % m_arraySize];
+			return m_arrays[m_chunk][m_itemIndex - m_chunkStart];
 		}
 
 		RigitIterator& operator++()
 		{
 			++m_itemIndex;
+			if (m_itemIndex == m_chunkEnd)
+			{
+				++m_chunk;
+				m_chunkStart = m_chunkEnd;
+				m_chunkEnd = Layout::chunkStart(m_chunk + 1);
+			}
 			return *this;
 		}
 
@@ -60,15 +123,18 @@ namespace CECS
 	private:
 		using Array = T*;
 		using ArrayContainer = std::vector<Array>;
+		using Layout = RigitLayout<T>;
 
 		ArrayContainer m_arrays;
 		Allocator m_allocator;
-		size_t m_arraySize;
 		size_t m_itemCount{};
+		size_t m_reserved{};
 
 	public:
-		RigitArray()
-			:m_arraySize{ m_allocator.chunkSize() }
+		RigitArray() = default;
+
+		RigitArray(const Allocator& allocator)
+			:m_allocator{ allocator }
 		{
 		}
 
@@ -79,10 +145,11 @@ namespace CECS
 		RigitArray(RigitArray&& rigitArray) noexcept :
 			m_arrays{ std::move(rigitArray.m_arrays) },
 			m_allocator{ std::move(rigitArray.m_allocator) },
-			m_arraySize{ rigitArray.m_arraySize },
-			m_itemCount{ rigitArray.m_itemCount }
+			m_itemCount{ rigitArray.m_itemCount },
+			m_reserved{ rigitArray.m_reserved }
 		{
 			rigitArray.m_itemCount = 0;
+			rigitArray.m_reserved = 0;
 		}
 
 		RigitArray& operator=(const RigitArray& rigitArray)
@@ -94,23 +161,28 @@ namespace CECS
 
 		RigitArray& operator=(RigitArray&& rigitArray) noexcept
 		{
+			m_reserved = 0;
 			clear();
 			m_arrays = std::move(rigitArray.m_arrays);
 			m_allocator = std::move(rigitArray.m_allocator);
-			m_arraySize = rigitArray.m_arraySize;
 			m_itemCount = rigitArray.m_itemCount;
+			m_reserved = rigitArray.m_reserved;
 			rigitArray.m_itemCount = 0;
+			rigitArray.m_reserved = 0;
 			return *this;
 		}
 
 		virtual ~RigitArray()
 		{
+			m_reserved = 0;
 			clear();
 		}
 
 		void pushBack(const T& item)
 		{
-			pushBack(T{ item });
+			increaseCapacity(m_itemCount + 1);
+			std::allocator_traits<Allocator>::construct(m_allocator, &get(m_itemCount), item);
+			++m_itemCount;
 		}
 
 		void pushBack(T&& item)
@@ -127,14 +199,36 @@ namespace CECS
 			decreaseCapacity(m_itemCount);
 		}
 
+		void eraseSwapBack(size_t index)
+		{
+			if (index + 1 != m_itemCount)
+			{
+				get(index) = std::move(back());
+			}
+			popBack();
+		}
+
+		void eraseSwapBack(const std::vector<size_t>& sortedIndices)
+		{
+			for (auto index{ sortedIndices.rbegin() }; index != sortedIndices.rend(); ++index)
+			{
+				eraseSwapBack(*index);
+			}
+		}
+
 		T& get(size_t index)
 		{
-			return m_arrays[index / m_arraySize][index % m_arraySize];
+			return m_arrays[Layout::chunkOf(index)][Layout::offsetOf(index)];
 		}
 
 		const T& get(size_t index) const
 		{
-			return m_arrays[index / m_arraySize][index % m_arraySize];
+			return m_arrays[Layout::chunkOf(index)][Layout::offsetOf(index)];
+		}
+
+		size_t contiguous(size_t index) const
+		{
+			return std::min(Layout::chunkStart(Layout::chunkOf(index) + 1), m_itemCount) - index;
 		}
 
 		void set(size_t index, const T& item)
@@ -172,11 +266,99 @@ namespace CECS
 			std::swap(get(left), get(right));
 		}
 
+		void append(const RigitArray& origin, size_t first, size_t count)
+		{
+			increaseCapacity(m_itemCount + count);
+			while (count)
+			{
+				size_t run{ std::min({ count, origin.contiguous(first), chunkRemainder(m_itemCount) }) };
+				const T* source{ &origin.get(first) };
+				T* destination{ &get(m_itemCount) };
+				if constexpr (std::is_trivially_copyable_v<T>)
+				{
+					std::memcpy(destination, source, run * sizeof(T));
+				}
+				else
+				{
+					std::uninitialized_copy_n(source, run, destination);
+				}
+				m_itemCount += run;
+				first += run;
+				count -= run;
+			}
+		}
+
+		void appendFilled(size_t count, const T& item)
+		{
+			increaseCapacity(m_itemCount + count);
+			while (count)
+			{
+				size_t run{ std::min(count, chunkRemainder(m_itemCount)) };
+				T* destination{ &get(m_itemCount) };
+				if constexpr (std::is_trivially_copyable_v<T>)
+				{
+					std::memcpy(destination, &item, sizeof(T));
+					for (size_t filled{ 1 }; filled < run; filled *= 2)
+					{
+						std::memcpy(destination + filled, destination, std::min(filled, run - filled) * sizeof(T));
+					}
+				}
+				else
+				{
+					std::uninitialized_fill_n(destination, run, item);
+				}
+				m_itemCount += run;
+				count -= run;
+			}
+		}
+
+		template<typename Generator>
+		void appendGenerated(size_t count, Generator&& generator)
+		{
+			increaseCapacity(m_itemCount + count);
+			for (size_t index{}; index < count;)
+			{
+				size_t run{ std::min(count - index, chunkRemainder(m_itemCount)) };
+				T* destination{ &get(m_itemCount) };
+				for (size_t item{}; item < run; ++item)
+				{
+					std::allocator_traits<Allocator>::construct(m_allocator, destination + item, generator(index + item));
+				}
+				m_itemCount += run;
+				index += run;
+			}
+		}
+
+		void appendMoved(RigitArray& origin, size_t first, size_t count)
+		{
+			increaseCapacity(m_itemCount + count);
+			while (count)
+			{
+				size_t run{ std::min({ count, origin.contiguous(first), chunkRemainder(m_itemCount) }) };
+				T* source{ &origin.get(first) };
+				T* destination{ &get(m_itemCount) };
+				if constexpr (std::is_trivially_copyable_v<T>)
+				{
+					std::memcpy(destination, source, run * sizeof(T));
+				}
+				else
+				{
+					std::uninitialized_move_n(source, run, destination);
+				}
+				m_itemCount += run;
+				first += run;
+				count -= run;
+			}
+		}
+
 		void clear()
 		{
-			for (size_t index{}; index < m_itemCount; ++index)
+			if constexpr (!std::is_trivially_destructible_v<T>)
 			{
-				destroy(index);
+				for (size_t index{}; index < m_itemCount; ++index)
+				{
+					destroy(index);
+				}
 			}
 			decreaseCapacity(0);
 			m_itemCount = 0;
@@ -189,7 +371,22 @@ namespace CECS
 
 		size_t capacity() const
 		{
-			return m_arraySize * m_arrays.size();
+			return Layout::chunkStart(m_arrays.size());
+		}
+
+		void reserve(size_t capacity)
+		{
+			m_reserved = std::max(m_reserved, capacity);
+			increaseCapacity(capacity);
+		}
+
+		void shrinkToFit()
+		{
+			m_reserved = 0;
+			while (!m_arrays.empty() && Layout::chunkStart(m_arrays.size() - 1) >= m_itemCount)
+			{
+				releaseChunk();
+			}
 		}
 
 		bool empty() const
@@ -197,23 +394,25 @@ namespace CECS
 			return !static_cast<bool>(m_itemCount);
 		}
 
+		const Allocator& getAllocator() const
+		{
+			return m_allocator;
+		}
+
 		RigitIterator<T> begin()
 		{
-			return RigitIterator<T>{m_arrays.data(), m_arraySize, 0};
+			return RigitIterator<T>{m_arrays.data(), 0};
 		}
 
 		RigitIterator<T> end()
 		{
-			return RigitIterator<T>{nullptr, 0, m_itemCount};
+			return RigitIterator<T>{nullptr, m_itemCount};
 		}
 
 		RigitArray copy() const
 		{
-			RigitArray<T, Allocator> out;
-			for (size_t index{}; index < m_itemCount; ++index)
-			{
-				out.pushBack(get(index));
-			}
+			RigitArray<T, Allocator> out{ m_allocator };
+			out.append(*this, 0, m_itemCount);
 			return out;
 		}
 
@@ -228,28 +427,43 @@ namespace CECS
 			std::allocator_traits<Allocator>::destroy(m_allocator, &get(index));
 		}
 
+		static size_t chunkRemainder(size_t index)
+		{
+			return Layout::chunkStart(Layout::chunkOf(index) + 1) - index;
+		}
+
 		void increaseCapacity(size_t newCapacity)
 		{
 			while (newCapacity > capacity())
 			{
-				m_arrays.push_back(std::allocator_traits<Allocator>::allocate(m_allocator, m_arraySize));
+				m_arrays.push_back(std::allocator_traits<Allocator>::allocate(m_allocator, Layout::chunkSize(m_arrays.size())));
 			}
 		}
 
 		void decreaseCapacity(size_t newCapacity)
 		{
-			if (newCapacity)
+			newCapacity = std::max(newCapacity, m_reserved);
+			if (newCapacity == 0)
 			{
-				newCapacity += m_arraySize;
+				while (!m_arrays.empty())
+				{
+					releaseChunk();
+				}
+				return;
 			}
 
-			while (capacity() > newCapacity)
+			while (m_arrays.size() > 1 && Layout::chunkStart(m_arrays.size() - 2) >= newCapacity)
 			{
-				Array removal{ m_arrays.back() };
-				std::allocator_traits<Allocator>::deallocate(m_allocator, removal, m_arraySize);
-				m_arrays.pop_back();
+				releaseChunk();
 			}
 		}
+
+		void releaseChunk()
+		{
+			Array removal{ m_arrays.back() };
+			std::allocator_traits<Allocator>::deallocate(m_allocator, removal, Layout::chunkSize(m_arrays.size() - 1));
+			m_arrays.pop_back();
+		}
 	};
 
 }
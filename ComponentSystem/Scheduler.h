@@ -0,0 +1,213 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Core.h"
+
+#include "JobSystem.h"
+#include "Accessor.h"
+#include "System.h"
+
+namespace CECS
+{
+	class Scheduler
+	{
+	private:
+		using SystemBase = std::unique_ptr<ISystem>;
+
+		struct Node
+		{
+			SystemAccess access;
+			std::vector<size_t> successors;
+			size_t dependencies{};
+		};
+
+		struct Stage
+		{
+			size_t first;
+			size_t last;
+		};
+
+		std::vector<SystemBase> m_systems;
+		std::vector<Node> m_nodes;
+		std::vector<Stage> m_stages;
+		std::vector<std::atomic<size_t>> m_remaining;
+		CommandBuffer m_merged;
+		ObserverPtr<JobSystem> m_jobs;
+		bool m_dirty{};
+
+	public:
+		Scheduler(JobSystem& jobs = JobSystem::instance())
+			:m_jobs{ &jobs }
+		{
+		}
+
+		Scheduler(const Scheduler& scheduler) = delete;
+
+		Scheduler& operator=(const Scheduler& scheduler) = delete;
+
+		~Scheduler()
+		{
+			for (auto system{ m_systems.rbegin() }; system != m_systems.rend(); ++system)
+			{
+				(*system)->terminate();
+			}
+		}
+
+		template<typename T, typename... Args>
+		T& addSystem(Args&&... args)
+		{
+			std::unique_ptr<T> system{ std::make_unique<T>(std::forward<Args>(args)...) };
+			T& out{ *system };
+			out.initilize();
+			m_systems.push_back(std::move(system));
+			m_dirty = true;
+			return out;
+		}
+
+		void invalidate()
+		{
+			m_dirty = true;
+		}
+
+		size_t size() const
+		{
+			return m_systems.size();
+		}
+
+		size_t getStageCount()
+		{
+			if (m_dirty)
+			{
+				build();
+			}
+			return m_stages.size();
+		}
+
+		void update()
+		{
+			if (m_dirty)
+			{
+				build();
+			}
+
+			for (const Stage& stage : m_stages)
+			{
+				run(stage);
+				// Stages only split where a later system observes pending structural changes
+				// or runs exclusively, so every stage boundary is a required sync point.
+				for (size_t system{ stage.first }; system < stage.last; ++system)
+				{
+					m_systems[system]->m_commands.merge(m_merged);
+				}
+				if (!m_merged.empty())
+				{
+					Accessor::playback(m_merged);
+					for (size_t system{ stage.first }; system < stage.last; ++system)
+					{
+						m_systems[system]->m_commands.resolved(m_merged);
+					}
+				}
+			}
+		}
+
+	private:
+		void build()
+		{
+			m_nodes.clear();
+			m_nodes.resize(m_systems.size());
+			m_stages.clear();
+
+			SystemAccess pending;
+			size_t first{};
+			for (size_t system{}; system < m_systems.size(); ++system)
+			{
+				Node& node{ m_nodes[system] };
+				m_systems[system]->declare(node.access);
+
+				if (system != first &&
+					(node.access.isExclusive() || m_nodes[system - 1].access.isExclusive() || node.access.observes(pending)))
+				{
+					m_stages.push_back(Stage{ first, system });
+					first = system;
+					pending.clear();
+				}
+
+				for (size_t previous{ first }; previous < system; ++previous)
+				{
+					if (m_nodes[previous].access.conflicts(node.access))
+					{
+						m_nodes[previous].successors.push_back(system);
+						++node.dependencies;
+					}
+				}
+
+				if (node.access.isStructural())
+				{
+					pending.merge(node.access);
+				}
+			}
+			if (!m_systems.empty())
+			{
+				m_stages.push_back(Stage{ first, m_systems.size() });
+			}
+
+			m_remaining = std::vector<std::atomic<size_t>>(m_systems.size());
+			m_dirty = false;
+		}
+
+		void run(const Stage& stage)
+		{
+			if (stage.last - stage.first == 1 || m_jobs->size() == 1)
+			{
+				for (size_t system{ stage.first }; system < stage.last; ++system)
+				{
+					JobContext context;
+					m_systems[system]->update();
+				}
+				return;
+			}
+
+			for (size_t system{ stage.first }; system < stage.last; ++system)
+			{
+				m_remaining[system].store(m_nodes[system].dependencies, std::memory_order_relaxed);
+			}
+
+			JobCounter counter;
+			for (size_t system{ stage.first }; system < stage.last; ++system)
+			{
+				if (m_nodes[system].dependencies == 0)
+				{
+					submit(system, counter);
+				}
+			}
+			m_jobs->wait(counter);
+		}
+
+		void submit(size_t system, JobCounter& counter)
+		{
+			m_jobs->submit([this, system, &counter]() { execute(system, counter); }, counter);
+		}
+
+		void execute(size_t system, JobCounter& counter)
+		{
+			{
+				JobContext context;
+				m_systems[system]->update();
+			}
+			for (size_t successor : m_nodes[system].successors)
+			{
+				if (m_remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					submit(successor, counter);
+				}
+			}
+		}
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef SHAREDMUTEX_H
+#define SHAREDMUTEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace CECS
+{
+#ifdef CECS_SINGLE_THREADED
+	class SharedMutex
+	{
+	public:
+		SharedMutex() = default;
+
+		SharedMutex(const SharedMutex& mutex) = delete;
+
+		SharedMutex& operator=(const SharedMutex& mutex) = delete;
+
+		void lock()
+		{
+		}
+
+		bool try_lock()
+		{
+			return true;
+		}
+
+		void unlock()
+		{
+		}
+
+		void lock_shared()
+		{
+		}
+
+		bool try_lock_shared()
+		{
+			return true;
+		}
+
+		void unlock_shared()
+		{
+		}
+	};
+#else
+	class SharedMutex
+	{
+	private:
+		static constexpr uint32_t WRITER{ uint32_t{ 1 } << 31 };
+
+		std::atomic<uint32_t> m_state{};
+
+	public:
+		SharedMutex() = default;
+
+		SharedMutex(const SharedMutex& mutex) = delete;
+
+		SharedMutex& operator=(const SharedMutex& mutex) = delete;
+
+		void lock()
+		{
+			while (m_state.fetch_or(WRITER, std::memory_order_acquire) & WRITER)
+			{
+				while (m_state.load(std::memory_order_relaxed) & WRITER)
+				{
+					std::this_thread::yield();
+				}
+			}
+			while (m_state.load(std::memory_order_acquire) != WRITER)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		bool try_lock()
+		{
+			uint32_t expected{};
+			return m_state.compare_exchange_strong(expected, WRITER, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+
+		void unlock()
+		{
+			m_state.fetch_and(~WRITER, std::memory_order_release);
+		}
+
+		void lock_shared()
+		{
+			while (m_state.fetch_add(1, std::memory_order_acquire) & WRITER)
+			{
+				m_state.fetch_sub(1, std::memory_order_relaxed);
+				while (m_state.load(std::memory_order_relaxed) & WRITER)
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		bool try_lock_shared()
+		{
+			if (m_state.fetch_add(1, std::memory_order_acquire) & WRITER)
+			{
+				m_state.fetch_sub(1, std::memory_order_relaxed);
+				return false;
+			}
+			return true;
+		}
+
+		void unlock_shared()
+		{
+			m_state.fetch_sub(1, std::memory_order_release);
+		}
+	};
+#endif
+}
+
+#endif
\ No newline at end of file
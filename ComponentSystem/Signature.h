@@ -1,9 +1,10 @@
 #ifndef SIGNATURE_H
 #define SIGNATURE_H
 
-#include <map>
-#include <bitset>
-#include <string>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
 #include <vector>
 
 #include "Core.h"
@@ -13,94 +14,78 @@ namespace CECS
 	class Signature
 	{
 	public:
-		using Bitset = std::bitset<BITSET_SIZE>;
+		using Word = uint64_t;
+
+		static constexpr size_t WORDS{ (MAX_COMPONENTS + BITSET_SIZE - 1) / BITSET_SIZE };
 
 	private:
-		using DynamicBitset = std::map<Index,Bitset>;
+		using WordArray = std::array<Word, WORDS>;
 
-		DynamicBitset m_bits;
+		WordArray m_words{};
 
 	public:
 		Signature() = default;
 
 		bool check(ComponentID id) const
 		{
-			return m_bits.at(id/BITSET_SIZE)[id%BITSET_SIZE];
+			return id < MAX_COMPONENTS && (m_words[id / BITSET_SIZE] >> (id % BITSET_SIZE)) & 1;
 		}
 
 		void set(ComponentID id, bool value = true)
 		{
-			auto check{ m_bits.find(id/BITSET_SIZE) };
-
-			if (check == m_bits.end()) 
-			{
-				m_bits[id /BITSET_SIZE] = Bitset{};
-			}
-
-			Bitset& bitsetBlock{ m_bits[id/BITSET_SIZE] };
-			bitsetBlock.set(id % BITSET_SIZE,value);
-
-			if (!bitsetBlock.any())
-			{
-				m_bits.erase(id/BITSET_SIZE);
-			}
+			Word mask{ Word{ 1 } << (id % BITSET_SIZE) };
+			Word& word{ m_words[id / BITSET_SIZE] };
+			word = value ? (word | mask) : (word & ~mask);
 		}
 
 		bool any() const
 		{
-			return !m_bits.empty();
+			Word out{};
+			for (Word word : m_words)
+			{
+				out |= word;
+			}
+			return out != 0;
 		}
 
-		Bitset& bitset(Index index)
+		size_t count() const
 		{
-			return m_bits[index];
+			size_t out{};
+			for (Word word : m_words)
+			{
+				out += std::popcount(word);
+			}
+			return out;
 		}
 
-		const Bitset& bitset(Index index) const
+		Word word(Index index) const
 		{
-			return m_bits.at(index);
+			return m_words[index];
 		}
 
 		bool subset(const Signature& aim) const
 		{
-			for (auto& pair : m_bits)
+			Word out{};
+			for (size_t index{}; index < WORDS; ++index)
 			{
-				auto check{ aim.m_bits.find(pair.first) };
-				if (check == aim.m_bits.end() || 
-					(bitset(pair.first) & aim.bitset(pair.first)) != bitset(pair.first))
-				{
-					return false;
-				}
+				out |= m_words[index] & ~aim.m_words[index];
 			}
-			return true;
+			return out == 0;
 		}
 
 		bool anyMatch(const Signature& aim) const
 		{
-			for (auto& pair : aim.m_bits)
+			Word out{};
+			for (size_t index{}; index < WORDS; ++index)
 			{
-				auto check{ m_bits.find(pair.first) };
-				if (check != m_bits.end() &&
-					(bitset(pair.first) & aim.bitset(pair.first)).any())
-				{
-					return true;
-				}
+				out |= m_words[index] & aim.m_words[index];
 			}
-			return false;
+			return out != 0;
 		}
 
 		bool operator==(const Signature& right) const
 		{
-			for (auto& pair : right.m_bits)
-			{
-				auto check{ m_bits.find(pair.first) };
-				if (check == m_bits.end() ||
-					(bitset(pair.first) == right.bitset(pair.first)))
-				{
-					return true;
-				}
-			}
-			return false;
+			return m_words == right.m_words;
 		}
 
 		bool operator!=(const Signature& right) const
@@ -110,43 +95,35 @@ namespace CECS
 
 		void operator+=(const Signature& signature)
 		{
-			for (const auto& pair : signature.m_bits)
+			for (size_t index{}; index < WORDS; ++index)
 			{
-				auto result{m_bits.find(pair.first)};
-				if (result != m_bits.end())
-				{
-					result->second = result->second | pair.second;
-				}
-				else
-				{
-					m_bits[pair.first] = pair.second;
-				}
+				m_words[index] |= signature.m_words[index];
 			}
 		}
 
 		std::vector<ComponentID> getComponents() const
 		{
 			std::vector<ComponentID> out;
-			for (auto& pair : m_bits)
+			out.reserve(count());
+			for (size_t index{}; index < WORDS; ++index)
 			{
-				for (ComponentID index{}; index < BITSET_SIZE; ++index)
+				for (Word word{ m_words[index] }; word; word &= word - 1)
 				{
-					if (pair.second.test(index))
-					{
-						out.push_back(pair.first * BITSET_SIZE + index);
-					}
+					out.push_back(static_cast<ComponentID>(index * BITSET_SIZE + std::countr_zero(word)));
 				}
 			}
 
 			return out;
 		}
 
-		const DynamicBitset& getBitsets() const
+		const WordArray& getWords() const
 		{
-			return m_bits;
+			return m_words;
 		}
 		
 	};
+
+	static_assert(std::is_trivially_copyable_v<Signature>);
 }
 
 #endif
\ No newline at end of file
@@ -1,10 +1,155 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+#include <algorithm>
+#include <vector>
+
+#include "Core.h"
+#include "TypeIndex.h"
+
+#include "CommandRecorder.h"
+
 namespace CECS
 {
+	class SystemAccess
+	{
+	private:
+		using TypeContainer = std::vector<TypeID>;
+
+		TypeContainer m_reads;
+		TypeContainer m_writes;
+		TypeContainer m_structural;
+		bool m_anyStructural{};
+		bool m_exclusive{};
+
+	public:
+		SystemAccess() = default;
+
+		template<typename... Args>
+		SystemAccess& read()
+		{
+			(insert(m_reads, TypeIndex::get<Args>()), ...);
+			return *this;
+		}
+
+		template<typename... Args>
+		SystemAccess& write()
+		{
+			(insert(m_writes, TypeIndex::get<Args>()), ...);
+			return *this;
+		}
+
+		template<typename... Args>
+		SystemAccess& structural()
+		{
+			if constexpr (sizeof...(Args) == 0)
+			{
+				m_anyStructural = true;
+			}
+			(insert(m_structural, TypeIndex::get<Args>()), ...);
+			return *this;
+		}
+
+		SystemAccess& exclusive()
+		{
+			m_exclusive = true;
+			return *this;
+		}
+
+		bool isExclusive() const
+		{
+			return m_exclusive;
+		}
+
+		bool isStructural() const
+		{
+			return m_anyStructural || !m_structural.empty();
+		}
+
+		bool conflicts(const SystemAccess& other) const
+		{
+			return m_exclusive || other.m_exclusive ||
+				overlaps(m_writes, other.m_writes) ||
+				overlaps(m_writes, other.m_reads) ||
+				overlaps(m_reads, other.m_writes);
+		}
+
+		bool observes(const SystemAccess& structural) const
+		{
+			if (structural.m_anyStructural)
+			{
+				return !m_reads.empty() || !m_writes.empty();
+			}
+			return overlaps(m_reads, structural.m_structural) || overlaps(m_writes, structural.m_structural);
+		}
+
+		void merge(const SystemAccess& other)
+		{
+			for (TypeID type : other.m_reads)
+			{
+				insert(m_reads, type);
+			}
+			for (TypeID type : other.m_writes)
+			{
+				insert(m_writes, type);
+			}
+			for (TypeID type : other.m_structural)
+			{
+				insert(m_structural, type);
+			}
+			m_anyStructural |= other.m_anyStructural;
+			m_exclusive |= other.m_exclusive;
+		}
+
+		void clear()
+		{
+			m_reads.clear();
+			m_writes.clear();
+			m_structural.clear();
+			m_anyStructural = false;
+			m_exclusive = false;
+		}
+
+	private:
+		static void insert(TypeContainer& types, TypeID type)
+		{
+			auto position{ std::lower_bound(types.begin(), types.end(), type) };
+			if (position == types.end() || *position != type)
+			{
+				types.insert(position, type);
+			}
+		}
+
+		static bool overlaps(const TypeContainer& left, const TypeContainer& right)
+		{
+			auto first{ left.begin() };
+			auto second{ right.begin() };
+			while (first != left.end() && second != right.end())
+			{
+				if (*first < *second)
+				{
+					++first;
+				}
+				else if (*second < *first)
+				{
+					++second;
+				}
+				else
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+
 	class ISystem
 	{
+	private:
+		CommandRecorder m_commands;
+
+		friend class Scheduler;
+
 	public:
 		ISystem() = default;
 
@@ -18,7 +163,23 @@ namespace CECS
 		{
 		}
 
+		virtual void declare(SystemAccess& access)
+		{
+			access.exclusive();
+		}
+
 		virtual void update() = 0;
+
+	protected:
+		CommandBuffer& commands()
+		{
+			return m_commands.local();
+		}
+
+		EntityID resolve(const CommandBuffer& lane, EntityID id)
+		{
+			return m_commands.resolve(lane, id);
+		}
 	};
 }
 
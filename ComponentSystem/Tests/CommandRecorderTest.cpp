@@ -0,0 +1,175 @@
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include "../CECS.h"
+
+using namespace CECS;
+
+struct Order
+{
+	int value;
+};
+
+static void check(bool condition, const char* message)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", message);
+		std::exit(1);
+	}
+}
+
+template<typename Function>
+static bool throwsOutOfRange(Function&& function)
+{
+	try
+	{
+		function();
+	}
+	catch (const std::out_of_range&)
+	{
+		return true;
+	}
+	return false;
+}
+
+static void record(CommandRecorder& recorder, int value)
+{
+	CommandBuffer& buffer{ recorder.local() };
+	buffer.addComponent(buffer.createEntity(), Order{ value });
+}
+
+static void recordNested(JobSystem& jobs, CommandRecorder& recorder)
+{
+	record(recorder, 0);
+	jobs.parallelFor(6, 1, [&jobs, &recorder](size_t first, size_t)
+		{
+			int outer{ 100 * (static_cast<int>(first) + 1) };
+			record(recorder, outer);
+			jobs.parallelFor(5, 2, [&recorder, outer](size_t first, size_t last)
+				{
+					for (size_t inner{ first }; inner < last; ++inner)
+					{
+						record(recorder, outer + 10 + static_cast<int>(inner));
+					}
+				});
+			record(recorder, outer + 50);
+			jobs.dispatch(3, [&recorder, outer](size_t job) { record(recorder, outer + 60 + static_cast<int>(job)); });
+			record(recorder, outer + 90);
+		});
+	record(recorder, 1);
+	jobs.dispatch(4, [&recorder](size_t job) { record(recorder, 2000 + static_cast<int>(job)); });
+	record(recorder, 3000);
+}
+
+static std::vector<int> expected()
+{
+	std::vector<int> out{ 0 };
+	for (int outer{ 100 }; outer <= 600; outer += 100)
+	{
+		out.push_back(outer);
+		for (int inner{}; inner < 5; ++inner)
+		{
+			out.push_back(outer + 10 + inner);
+		}
+		out.push_back(outer + 50);
+		for (int job{}; job < 3; ++job)
+		{
+			out.push_back(outer + 60 + job);
+		}
+		out.push_back(outer + 90);
+	}
+	out.push_back(1);
+	for (int job{}; job < 4; ++job)
+	{
+		out.push_back(2000 + job);
+	}
+	out.push_back(3000);
+	return out;
+}
+
+static std::vector<int> playback(CommandRecorder& recorder)
+{
+	Pool pool;
+	EntityID first{ pool.createEntity() };
+	recorder.playback(pool);
+
+	std::vector<int> out;
+	for (EntityID id{ first + 1 }; pool.isAlive(id); ++id)
+	{
+		out.push_back(pool.getComponent<Order>(id).value);
+	}
+	return out;
+}
+
+struct Created
+{
+	const CommandBuffer* lane;
+	EntityID id;
+	int value;
+};
+
+static void checkResolve(JobSystem& jobs)
+{
+	CommandRecorder recorder;
+	std::vector<Created> created(9);
+	auto create{ [&recorder, &created](size_t index)
+		{
+			CommandBuffer& buffer{ recorder.local() };
+			EntityID id{ buffer.createEntity() };
+			buffer.addComponent(id, Order{ static_cast<int>(index) });
+			created[index] = Created{ &buffer, id, static_cast<int>(index) };
+		} };
+	create(0);
+	jobs.dispatch(7, [&create](size_t job) { create(job + 1); });
+	create(8);
+
+	const CommandBuffer& lane{ *created[3].lane };
+	check(throwsOutOfRange([&]() { recorder.resolve(lane, created[3].id); }), "resolving before playback must throw");
+	check(throwsOutOfRange([&]() { lane.resolve(created[3].id); }), "resolving on an unplayed lane must throw");
+
+	Pool pool;
+	recorder.playback(pool);
+	std::vector<EntityID> resolved;
+	for (const Created& item : created)
+	{
+		EntityID id{ recorder.resolve(*item.lane, item.id) };
+		check(pool.isAlive(id), "a resolved entity must be alive");
+		check(pool.getComponent<Order>(id).value == item.value, "a resolved entity must carry its own components");
+		resolved.push_back(id);
+	}
+	for (size_t index{ 1 }; index < resolved.size(); ++index)
+	{
+		check(resolved[index - 1] < resolved[index], "entities must be created in lane order");
+	}
+	check(throwsOutOfRange([&]() { lane.resolve(created[3].id); }), "a merged lane must not resolve renumbered entities");
+	check(throwsOutOfRange([&]() { recorder.resolve(lane, created[3].id + 100); }), "an unknown provisional entity must throw");
+	check(recorder.resolve(lane, resolved.front()) == resolved.front(), "a real entity must resolve to itself");
+
+	recorder.playback(pool);
+	check(throwsOutOfRange([&]() { recorder.resolve(lane, created[3].id); }), "entities must not resolve after the next merge");
+}
+
+int main()
+{
+	const std::vector<int> order{ expected() };
+	CommandRecorder recorder;
+	for (size_t threads : { 1, 2, 4, 8 })
+	{
+		JobSystem jobs{ threads };
+		for (int repeat{}; repeat < 20; ++repeat)
+		{
+			recordNested(jobs, recorder);
+			check(playback(recorder) == order, "nested recording must play back in serial program order");
+		}
+		{
+			JobContext context;
+			recordNested(jobs, recorder);
+		}
+		check(playback(recorder) == order, "recording under a fresh job context must play back in the same order");
+		checkResolve(jobs);
+	}
+	std::printf("ok\n");
+}
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../CECS.h"
+
+using namespace CECS;
+
+struct Position
+{
+	EntityID owner;
+	float x;
+};
+
+struct Velocity
+{
+	EntityID owner;
+};
+
+struct Health
+{
+	int value;
+};
+
+struct Tag
+{
+	int value;
+};
+
+static void check(bool condition, const char* message)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", message);
+		std::exit(1);
+	}
+}
+
+template<typename Function>
+static bool throws(Function&& function)
+{
+	try
+	{
+		function();
+	}
+	catch (const std::exception&)
+	{
+		return true;
+	}
+	return false;
+}
+
+static void checkLocking(Pool& pool)
+{
+	EntityID bare{ pool.createEntity() };
+	EntityID dead{ pool.createEntity() };
+	pool.addComponent(dead, Health{ 1 });
+	pool.destroyEntity(dead);
+
+	check(throws([&]() { pool.getComponent<Health>(bare); }), "getComponent on an entity without components must throw");
+	check(throws([&]() { pool.readComponent<Health>(dead); }), "readComponent on a destroyed entity must throw");
+	pool.setComponent(dead, Health{ 2 });
+	check(!pool.isAlive(dead), "setComponent must not revive a destroyed entity");
+	pool.destroyEntity(bare);
+
+	{
+		Pool::StructureLock exclusive{ pool, true };
+		Pool::StructureLock shared{ pool, false };
+		Pool::StructureLock nested{ pool, true };
+	}
+	{
+		Pool::StructureLock shared{ pool, false };
+		check(throws([&]() { Pool::StructureLock upgrade{ pool, true }; }), "upgrading a shared structure lock must throw");
+	}
+	std::thread{ [&pool]() { Pool::StructureLock exclusive{ pool, true }; } }.join();
+
+	Pool other;
+	{
+		Pool::StructureLock first{ pool, true };
+		Pool::StructureLock second{ other, true };
+		Pool::StructureLock again{ pool, true };
+		EntityID id{ other.createEntity() };
+		check(other.isAlive(id), "an entity created while two pools are locked must be alive");
+		pool.destroyEntity(pool.createEntity());
+	}
+	{
+		Pool::StructureLock first{ pool, true };
+		Pool::StructureLock second{ other, false };
+		check(throws([&]() { Pool::StructureLock upgrade{ other, true }; }), "upgrading a shared structure lock on a second pool must throw");
+	}
+	std::thread{ [&pool, &other]()
+		{
+			Pool::StructureLock first{ other, true };
+			Pool::StructureLock second{ pool, true };
+		} }.join();
+
+	std::vector<Pool> pools(9);
+	check(throws([&]()
+		{
+			std::vector<std::unique_ptr<Pool::StructureLock>> locks;
+			for (Pool& item : pools)
+			{
+				locks.push_back(std::make_unique<Pool::StructureLock>(item, false));
+			}
+		}), "locking more pools than a thread can track must throw");
+	Pool::StructureLock exclusive{ pools.back(), true };
+}
+
+int main(int argc, char** argv)
+{
+	const size_t perThread{ argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000 };
+	const size_t iterations{ argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000 };
+	const size_t structural{ 3 };
+	const size_t writers{ 2 };
+	const size_t readers{ 3 };
+
+	Pool& pool{ *Accessor::getPool() };
+	checkLocking(pool);
+
+	std::vector<EntityID> ids;
+	for (size_t index{}; index < perThread * (structural + writers); ++index)
+	{
+		EntityID id{ Accessor::createEntity() };
+		Accessor::addComponents(id, Position{ id, 0 }, Health{ 0 });
+		ids.push_back(id);
+	}
+
+	EntityID warm{ ids.front() };
+	Accessor::addComponent(warm, Velocity{ warm });
+	Accessor::addComponent(warm, Tag{ 1 });
+	Accessor::removeComponent<Velocity>(warm);
+	Accessor::removeComponent<Tag>(warm);
+	Accessor::addComponent(warm, Tag{ 1 });
+	Accessor::addComponent(warm, Velocity{ warm });
+	Accessor::removeComponent<Tag>(warm);
+	Accessor::removeComponent<Velocity>(warm);
+
+	std::atomic<bool> start{};
+	std::atomic<bool> stop{};
+	std::atomic<size_t> moves{};
+	std::atomic<size_t> writes{};
+	std::atomic<size_t> reads{};
+	std::atomic<size_t> destroyed{};
+	std::vector<std::thread> threads;
+
+	for (size_t thread{}; thread < structural; ++thread)
+	{
+		threads.emplace_back([&, thread]()
+			{
+				std::mt19937 random{ static_cast<unsigned>(thread) };
+				while (!start)
+				{
+					std::this_thread::yield();
+				}
+				for (size_t iteration{}; iteration < iterations; ++iteration)
+				{
+					EntityID id{ ids[thread * perThread + random() % perThread] };
+					if (!Accessor::isAlive(id))
+					{
+						continue;
+					}
+					switch (random() % 5)
+					{
+					case 0:
+						Accessor::addComponent(id, Velocity{ id });
+						break;
+					case 1:
+						Accessor::removeComponent<Velocity>(id);
+						break;
+					case 2:
+						Accessor::addComponent(id, Tag{ 3 });
+						break;
+					case 3:
+						Accessor::removeComponent<Tag>(id);
+						break;
+					default:
+						if (random() % 50 == 0)
+						{
+							Accessor::destroyEntity(id);
+							++destroyed;
+						}
+						break;
+					}
+					++moves;
+				}
+			});
+	}
+
+	for (size_t thread{}; thread < writers; ++thread)
+	{
+		threads.emplace_back([&, thread]()
+			{
+				std::mt19937 random{ static_cast<unsigned>(100 + thread) };
+				while (!start)
+				{
+					std::this_thread::yield();
+				}
+				size_t first{ (structural + thread) * perThread };
+				for (size_t iteration{}; iteration < iterations; ++iteration)
+				{
+					EntityID id{ ids[first + random() % perThread] };
+					Health health{ Accessor::readComponent<Health>(id) };
+					Accessor::setComponent(id, Health{ health.value + 1 });
+					++writes;
+				}
+			});
+	}
+
+	for (size_t thread{}; thread < readers; ++thread)
+	{
+		threads.emplace_back([&, thread]()
+			{
+				std::mt19937 random{ static_cast<unsigned>(200 + thread) };
+				while (!start)
+				{
+					std::this_thread::yield();
+				}
+				while (!stop)
+				{
+					EntityID id{ ids[random() % ids.size()] };
+					if (!Accessor::isAlive(id))
+					{
+						continue;
+					}
+					Accessor::hasComponent<Velocity>(id);
+					if (id >= ids[structural * perThread])
+					{
+						check(Accessor::readComponent<Position>(id).owner == id, "torn read");
+					}
+					++reads;
+				}
+			});
+	}
+
+	start = true;
+	for (size_t thread{}; thread < structural + writers; ++thread)
+	{
+		threads[thread].join();
+	}
+	stop = true;
+	for (size_t thread{ structural + writers }; thread < threads.size(); ++thread)
+	{
+		threads[thread].join();
+	}
+
+	size_t alive{};
+	size_t velocities{};
+	size_t health{};
+	for (EntityID id : ids)
+	{
+		if (!Accessor::isAlive(id))
+		{
+			continue;
+		}
+		++alive;
+		check(Accessor::getComponent<Position>(id).owner == id, "position moved to the wrong entity");
+		if (Accessor::hasComponent<Velocity>(id))
+		{
+			++velocities;
+			check(Accessor::getComponent<Velocity>(id).owner == id, "velocity moved to the wrong entity");
+		}
+		health += static_cast<size_t>(Accessor::getComponent<Health>(id).value);
+	}
+
+	size_t viewed{};
+	for (auto [id, position] : PoolView<Position>{})
+	{
+		check(position.owner == id, "view row does not match its entity");
+		++viewed;
+	}
+	size_t viewedVelocities{};
+	for (auto [id, velocity] : PoolView<Velocity>{})
+	{
+		check(velocity.owner == id, "view row does not match its entity");
+		++viewedVelocities;
+	}
+	ObserverPtr<Query> query{ Accessor::createQuery<Position>() };
+
+	check(viewed == alive, "view and entity table disagree");
+	check(viewedVelocities == velocities, "velocity view and entity table disagree");
+	check(query->size() == alive, "query count and entity table disagree");
+	check(health == writers * iterations, "lost health update");
+
+	std::printf("ok moves %zu writes %zu reads %zu destroyed %zu alive %zu\n",
+		moves.load(), writes.load(), reads.load(), destroyed.load(), alive);
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include "../CECS.h"
+
+using namespace CECS;
+
+static void check(bool condition, const char* message)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", message);
+		std::exit(1);
+	}
+}
+
+template<typename Function>
+static std::string thrown(Function&& function)
+{
+	try
+	{
+		function();
+	}
+	catch (const std::exception& exception)
+	{
+		return exception.what();
+	}
+	return {};
+}
+
+static void checkDispatch(JobSystem& jobs)
+{
+	std::atomic<size_t> ran{};
+	std::string message{ thrown([&]()
+		{
+			jobs.dispatch(64, [&ran](size_t job)
+				{
+					if (job % 16 == 3)
+					{
+						throw std::runtime_error{ "dispatch" };
+					}
+					++ran;
+				});
+		}) };
+	check(message == "dispatch", "dispatch must rethrow the job's exception");
+	check(ran == 60, "a throwing job must not stop the other jobs");
+
+	ran = 0;
+	jobs.parallelFor(1000, 10, [&ran](size_t first, size_t last) { ran += last - first; });
+	check(ran == 1000, "the job system must be usable after a job threw");
+}
+
+static void checkSubmit(JobSystem& jobs)
+{
+	JobCounter counter;
+	std::atomic<size_t> ran{};
+	for (size_t job{}; job < 32; ++job)
+	{
+		jobs.submit([&ran, job]()
+			{
+				if (job == 7)
+				{
+					throw std::logic_error{ "submit" };
+				}
+				++ran;
+			}, counter);
+	}
+	check(thrown([&]() { jobs.wait(counter); }) == "submit", "wait must rethrow the first captured exception");
+	check(counter.done(), "the counter must reach zero even when a job throws");
+	check(ran == 31, "a throwing job must not stop the other jobs");
+
+	jobs.submit([&ran]() { ++ran; }, counter);
+	check(thrown([&]() { jobs.wait(counter); }).empty(), "an exception must be rethrown only once");
+	check(ran == 32, "the counter must be reusable after a failure");
+}
+
+static void checkNested(JobSystem& jobs)
+{
+	std::atomic<size_t> caught{};
+	jobs.dispatch(8, [&jobs, &caught](size_t outer)
+		{
+			std::string message{ thrown([&jobs, outer]()
+				{
+					jobs.parallelFor(16, 1, [outer](size_t first, size_t)
+						{
+							if (first == outer)
+							{
+								throw std::out_of_range{ "nested" };
+							}
+						});
+				}) };
+			if (message == "nested")
+			{
+				++caught;
+			}
+		});
+	check(caught == 8, "a nested dispatch must rethrow into its own job");
+
+	check(thrown([&jobs]()
+		{
+			jobs.dispatch(4, [&jobs](size_t)
+				{
+					jobs.dispatch(4, [](size_t job)
+						{
+							if (job == 2)
+							{
+								throw std::runtime_error{ "propagated" };
+							}
+						});
+				});
+		}) == "propagated", "an uncaught nested exception must reach the outer wait");
+}
+
+int main()
+{
+	for (size_t threads : { 1, 2, 4 })
+	{
+		JobSystem jobs{ threads };
+		checkDispatch(jobs);
+		checkSubmit(jobs);
+		checkNested(jobs);
+	}
+	std::printf("ok\n");
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef TYPEINDEX_H
+#define TYPEINDEX_H
+
+#include <atomic>
+#include <type_traits>
+
+#include "Core.h"
+
+namespace CECS
+{
+	class TypeIndex
+	{
+	public:
+		template<typename T>
+		static TypeID get()
+		{
+			return id<std::remove_cvref_t<T>>();
+		}
+
+	private:
+		template<typename T>
+		static TypeID id()
+		{
+			static const TypeID out{ next() };
+			return out;
+		}
+
+		static TypeID next()
+		{
+			static std::atomic<TypeID> counter{};
+			return counter.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+}
+
+#endif
\ No newline at end of file